@@ -0,0 +1,850 @@
+#ifndef COMPACT_VECTOR_HPP
+#define COMPACT_VECTOR_HPP 1
+
+#include <cstdint>
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	namespace detail {
+
+		//Holds an allocator, taking up no space when the allocator is empty
+		template<class Allocator, bool = std::is_empty<Allocator>::value && !std::is_final<Allocator>::value>
+		class allocator_holder : private Allocator {
+		public:
+			explicit allocator_holder(const Allocator &alloc) : Allocator(alloc) {}
+
+			Allocator& heldAllocator() {
+				return *this;
+			}
+
+			const Allocator& heldAllocator() const {
+				return *this;
+			}
+		};
+
+		template<class Allocator>
+		class allocator_holder<Allocator, false> {
+		public:
+			explicit allocator_holder(const Allocator &alloc) : allocator(alloc) {}
+
+			Allocator& heldAllocator() {
+				return allocator;
+			}
+
+			const Allocator& heldAllocator() const {
+				return allocator;
+			}
+
+		private:
+			Allocator allocator;
+		};
+	}
+
+	//The interface of sandsnip3r::vector in 16 bytes: one pointer plus a 32-bit size and capacity, with
+	//	no virtual functions and no room taken by an empty allocator
+	//Holds at most 2^32-1 elements. Iterators are plain pointers
+	template<class Type, class Allocator = std::allocator<Type>, class GrowthPolicy = default_growth>
+	class compact_vector : private detail::allocator_holder<Allocator> {
+	public:
+		using allocator_type 	= Allocator;
+		using value_type 			= typename Allocator::value_type;
+		using size_type 			= std::uint32_t;
+		using difference_type = typename Allocator::difference_type;
+		using reference 			= typename Allocator::reference;
+		using const_reference = typename Allocator::const_reference;
+		using pointer 				= typename Allocator::pointer;
+		using const_pointer 	= typename Allocator::const_pointer;
+		using iterator 				= pointer;
+		using const_iterator 	= const_pointer;
+		using reverse_iterator 				= std::reverse_iterator<iterator>;
+		using const_reverse_iterator 	= std::reverse_iterator<const_iterator>;
+
+	private:
+		using holder = detail::allocator_holder<Allocator>;
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		pointer dataBegin{nullptr};
+		size_type dataSize{0};
+		size_type dataCapacity{0};
+
+		allocator_type& vectorAllocator() {
+			return holder::heldAllocator();
+		}
+
+		pointer dataEnd() const {
+			return dataBegin + dataSize;
+		}
+
+		pointer allocate(size_type capacity) {
+			return allocatorTraits::allocate(vectorAllocator(), capacity);
+		}
+
+		void deallocate(pointer data, size_type capacity) {
+			if (data != nullptr) {
+				allocatorTraits::deallocate(vectorAllocator(), data, capacity);
+			}
+		}
+
+		size_type nextCapacity(std::size_t required) const {
+			if (required > max_size()) {
+				throw std::length_error("compact_vector: size (which is "+std::to_string(required)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			return std::min(GrowthPolicy::next_capacity(dataCapacity, static_cast<size_type>(required), sizeof(value_type)), max_size());
+		}
+
+		void reallocateIfNecessary() {
+			if (dataSize == dataCapacity) {
+				reallocate(nextCapacity(std::size_t(dataSize) + 1));
+			}
+		}
+
+		void reallocateToNewSizeIfNecessary(size_type newCapacity) {
+			if (dataCapacity < newCapacity) {
+				reallocate(newCapacity);
+			}
+		}
+
+		//Counts are taken as std::size_t so a request beyond 2^32-1 elements throws rather than wrapping
+		size_type checkedSize(std::size_t count, const char *function) const {
+			if (count > max_size()) {
+				throw std::length_error(std::string(function)+" count (which is "+std::to_string(count)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			return static_cast<size_type>(count);
+		}
+
+		void reallocate(size_type newCapacity) {
+			if (newCapacity > max_size()) {
+				throw std::length_error("compact_vector::reallocate() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			if (dataBegin != nullptr) {
+				if constexpr (detail::has_reallocate<allocator_type>::value && is_trivially_relocatable_v<value_type>) {
+					dataBegin = vectorAllocator().reallocate(dataBegin, dataCapacity, newCapacity);
+					dataCapacity = newCapacity;
+					return;
+				} else if constexpr (detail::has_expand<allocator_type>::value) {
+					if (vectorAllocator().expand(dataBegin, dataCapacity, newCapacity)) {
+						dataCapacity = newCapacity;
+						return;
+					}
+				}
+			}
+			pointer newDataBegin = allocate(newCapacity);
+			try {
+				detail::relocate(vectorAllocator(), dataBegin, dataEnd(), newDataBegin);
+			} catch (...) {
+				deallocate(newDataBegin, newCapacity);
+				throw;
+			}
+			deallocate(dataBegin, dataCapacity);
+			dataBegin = newDataBegin;
+			dataCapacity = newCapacity;
+		}
+
+		//Same as vector::insertElements
+		template<class ConstructElements>
+		iterator insertElements(size_type index, size_type count, ConstructElements constructElements) {
+			if (count > dataCapacity - dataSize) {
+				const size_type newCapacity = nextCapacity(std::size_t(dataSize) + count);
+				pointer newDataBegin = allocate(newCapacity);
+				try {
+					detail::relocateAroundGap(vectorAllocator(), dataBegin, dataBegin + index, dataEnd(), newDataBegin, count, constructElements);
+				} catch (...) {
+					deallocate(newDataBegin, newCapacity);
+					throw;
+				}
+				deallocate(dataBegin, dataCapacity);
+				dataBegin = newDataBegin;
+				dataCapacity = newCapacity;
+				dataSize += count;
+			} else if (count > 0) {
+				detail::insertInPlace(dataBegin + index, dataEnd(), count, constructElements);
+				dataSize += count;
+			}
+			return dataBegin + index;
+		}
+
+		void constructCopies(pointer destination, size_type count, const value_type &value) {
+			size_type constructed = 0;
+			try {
+				for (; constructed<count; ++constructed) {
+					allocatorTraits::construct(vectorAllocator(), destination + constructed, value);
+				}
+			} catch (...) {
+				destroyElements(destination, destination + constructed);
+				throw;
+			}
+		}
+
+		template<class InputIt>
+		void constructRange(pointer destination, InputIt first, size_type count) {
+			size_type constructed = 0;
+			try {
+				for (; constructed<count; ++constructed, ++first) {
+					allocatorTraits::construct(vectorAllocator(), destination + constructed, *first);
+				}
+			} catch (...) {
+				destroyElements(destination, destination + constructed);
+				throw;
+			}
+		}
+
+		void destroyElements(pointer first, pointer last) {
+			detail::destroyRange(vectorAllocator(), first, last);
+		}
+
+		//Makes room for count elements in a vector holding none, without relocating anything
+		void reserveEmpty(size_type count) {
+			if (dataCapacity < count) {
+				pointer newDataBegin = allocate(count);
+				deallocate(dataBegin, dataCapacity);
+				dataBegin = newDataBegin;
+				dataCapacity = count;
+			}
+		}
+
+		//Same as vector::assignElements
+		template<class ForwardIt>
+		void assignElements(ForwardIt first, size_type count) {
+			if (count > dataCapacity) {
+				resizeDown(0);
+				reserveEmpty(count);
+				constructRange(dataBegin, first, count);
+			} else {
+				detail::assignOver(vectorAllocator(), dataBegin, dataSize, first, count, [&](pointer destination, ForwardIt source, size_type sourceCount) {
+					constructRange(destination, source, sourceCount);
+				});
+			}
+			dataSize = count;
+		}
+
+		//Like vector::initialize, constructors fill their buffer through this since the destructor won't
+		//	run to release it if filling throws
+		template<class Fill>
+		void initialize(Fill fill) {
+			try {
+				fill();
+			} catch (...) {
+				resizeDown(0);
+				deallocate(dataBegin, dataCapacity);
+				dataBegin = nullptr;
+				dataCapacity = 0;
+				throw;
+			}
+		}
+
+		bool isElement(const value_type &value) const {
+			std::less<const value_type*> less;
+			const value_type *address = std::addressof(value);
+			return !less(address, dataBegin) && less(address, dataEnd());
+		}
+
+		void growDefaultInitialized(size_type count) {
+			reallocateToNewSizeIfNecessary(count);
+			if constexpr (!std::is_trivially_default_constructible<value_type>::value) {
+				pointer current = dataEnd();
+				try {
+					for (; current != dataBegin + count; ++current) {
+						::new (static_cast<void*>(current)) value_type;
+					}
+				} catch (...) {
+					destroyElements(dataEnd(), current);
+					throw;
+				}
+			}
+			dataSize = count;
+		}
+
+		void resizeDown(size_type count) {
+			destroyElements(dataBegin + count, dataEnd());
+			dataSize = count;
+		}
+
+		void stealStorage(compact_vector &other) {
+			dataBegin = other.dataBegin;
+			dataSize = other.dataSize;
+			dataCapacity = other.dataCapacity;
+			other.dataBegin = nullptr;
+			other.dataSize = 0;
+			other.dataCapacity = 0;
+		}
+
+		void moveElementsFrom(compact_vector &other) {
+			reallocateToNewSizeIfNecessary(other.dataSize);
+			for (size_type i=0; i<other.dataSize; ++i) {
+				allocatorTraits::construct(vectorAllocator(), dataBegin + i, std::move(other.dataBegin[i]));
+				++dataSize;
+			}
+		}
+
+	public:
+		compact_vector() : compact_vector(Allocator()) {}
+
+		explicit compact_vector(const Allocator &alloc) : holder(alloc) {}
+
+		explicit compact_vector(std::size_t count, const Allocator &alloc = Allocator()) : holder(alloc) {
+			initialize([&]() {
+				resize(count);
+			});
+		}
+
+		compact_vector(std::size_t count, default_init_t, const Allocator &alloc = Allocator()) : holder(alloc) {
+			initialize([&]() {
+				resize_for_overwrite(count);
+			});
+		}
+
+		compact_vector(std::size_t count, const Type &value, const Allocator &alloc = Allocator()) : holder(alloc) {
+			initialize([&]() {
+				resize(count, value);
+			});
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		compact_vector(InputIt first, InputIt last, const Allocator &alloc = Allocator()) : holder(alloc) {
+			initialize([&]() {
+				insert(end(), first, last);
+			});
+		}
+
+		compact_vector(std::initializer_list<Type> ilist, const Allocator &alloc = Allocator()) : compact_vector(ilist.begin(), ilist.end(), alloc) {}
+
+		compact_vector(const compact_vector &other) : compact_vector(other, allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+		compact_vector(const compact_vector &other, const Allocator &alloc) : holder(alloc) {
+			initialize([&]() {
+				reallocate(other.dataSize);
+				constructRange(dataBegin, other.dataBegin, other.dataSize);
+				dataSize = other.dataSize;
+			});
+		}
+
+		compact_vector(compact_vector &&other) noexcept : holder(std::move(other.vectorAllocator())) {
+			stealStorage(other);
+		}
+
+		compact_vector(compact_vector &&other, const Allocator &alloc) : holder(alloc) {
+			if (alloc == other.get_allocator()) {
+				stealStorage(other);
+			} else {
+				initialize([&]() {
+					moveElementsFrom(other);
+				});
+			}
+		}
+
+		~compact_vector() {
+			resizeDown(0);
+			deallocate(dataBegin, dataCapacity);
+		}
+
+		compact_vector& operator=(const compact_vector &other) {
+			if (&other != this) {
+				if (typename allocatorTraits::propagate_on_container_copy_assignment()) {
+					if (vectorAllocator() != other.get_allocator()) {
+						//Our buffer belongs to the allocator we are about to replace
+						resizeDown(0);
+						deallocate(dataBegin, dataCapacity);
+						dataBegin = nullptr;
+						dataCapacity = 0;
+					}
+					vectorAllocator() = other.get_allocator();
+				}
+				//Assign over the elements we already have, so they can keep what they own
+				assignElements(other.dataBegin, other.dataSize);
+			}
+			return *this;
+		}
+
+		compact_vector& operator=(compact_vector &&other) noexcept(allocatorTraits::propagate_on_container_move_assignment::value || allocatorTraits::is_always_equal::value) {
+			if (&other != this) {
+				resizeDown(0);
+				if (typename allocatorTraits::propagate_on_container_move_assignment() || vectorAllocator() == other.get_allocator()) {
+					deallocate(dataBegin, dataCapacity);
+					if (typename allocatorTraits::propagate_on_container_move_assignment()) {
+						vectorAllocator() = std::move(other.vectorAllocator());
+					}
+					stealStorage(other);
+				} else {
+					//Allocators are different and dont propigate
+					moveElementsFrom(other);
+				}
+			}
+			return *this;
+		}
+
+		compact_vector& operator=(std::initializer_list<value_type> ilist) {
+			assign(ilist.begin(), ilist.end());
+			return *this;
+		}
+
+		void assign(std::size_t requestedCount, const value_type &value) {
+			const size_type count = checkedSize(requestedCount, "compact_vector::assign()");
+			if (count > dataCapacity) {
+				if (isElement(value)) {
+					//Clearing would destroy value
+					value_type copy(value);
+					assign(count, copy);
+					return;
+				}
+				resizeDown(0);
+				reserveEmpty(count);
+				constructCopies(dataBegin, count, value);
+			} else {
+				const size_type common = std::min(dataSize, count);
+				std::fill(dataBegin, dataBegin + common, value);
+				if (count > common) {
+					constructCopies(dataEnd(), count - common, value);
+				} else {
+					resizeDown(count);
+				}
+			}
+			dataSize = count;
+		}
+
+		//The range must not be part of this vector
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		void assign(InputIt first, InputIt last) {
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				assignElements(first, checkedSize(std::distance(first, last), "compact_vector::assign()"));
+			} else {
+				resizeDown(0);
+				for (; first != last; ++first) {
+					emplace_back(*first);
+				}
+			}
+		}
+
+		void assign(std::initializer_list<value_type> ilist) {
+			assign(ilist.begin(), ilist.end());
+		}
+
+		allocator_type get_allocator() const {
+			return holder::heldAllocator();
+		}
+
+		reference at(size_type pos) {
+			if (pos >= size()) {
+				throw std::out_of_range("compact_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return dataBegin[pos];
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= size()) {
+				throw std::out_of_range("compact_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return dataBegin[pos];
+		}
+
+		reference operator[](size_type pos) {
+			return dataBegin[pos];
+		}
+
+		const_reference operator[](size_type pos) const {
+			return dataBegin[pos];
+		}
+
+		reference front() {
+			return *begin();
+		}
+
+		const_reference front() const {
+			return *begin();
+		}
+
+		reference back() {
+			return *(end() - 1);
+		}
+
+		const_reference back() const {
+			return *(end() - 1);
+		}
+
+		pointer data() {
+			return dataBegin;
+		}
+
+		const_pointer data() const {
+			return dataBegin;
+		}
+
+		iterator begin() {
+			return dataBegin;
+		}
+
+		const_iterator begin() const {
+			return dataBegin;
+		}
+
+		const_iterator cbegin() const {
+			return dataBegin;
+		}
+
+		iterator end() {
+			return dataEnd();
+		}
+
+		const_iterator end() const {
+			return dataEnd();
+		}
+
+		const_iterator cend() const {
+			return dataEnd();
+		}
+
+		reverse_iterator rbegin() {
+			return reverse_iterator(end());
+		}
+
+		const_reverse_iterator rbegin() const {
+			return const_reverse_iterator(end());
+		}
+
+		const_reverse_iterator crbegin() const {
+			return const_reverse_iterator(end());
+		}
+
+		reverse_iterator rend() {
+			return reverse_iterator(begin());
+		}
+
+		const_reverse_iterator rend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		const_reverse_iterator crend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		bool empty() const {
+			return dataSize == 0;
+		}
+
+		size_type size() const {
+			return dataSize;
+		}
+
+		size_type max_size() const {
+			return static_cast<size_type>(std::min<std::size_t>(allocatorTraits::max_size(holder::heldAllocator()), std::numeric_limits<size_type>::max()));
+		}
+
+		void reserve(std::size_t newCapacity) {
+			reallocateToNewSizeIfNecessary(checkedSize(newCapacity, "compact_vector::reserve()"));
+		}
+
+		size_type capacity() const {
+			return dataCapacity;
+		}
+
+		void shrink_to_fit() {
+			if (dataSize < dataCapacity) {
+				reallocate(dataSize);
+			}
+		}
+
+		void clear() {
+			resizeDown(0);
+		}
+
+		iterator insert(const_iterator pos, const value_type &value) {
+			return insert(pos, 1, value);
+		}
+
+		iterator insert(const_iterator pos, value_type &&value) {
+			return emplace(pos, std::move(value));
+		}
+
+		iterator insert(const_iterator pos, std::size_t count, const value_type &value) {
+			const size_type index = pos - cbegin();
+			if (count > std::size_t(max_size() - dataSize)) {
+				throw std::length_error("compact_vector::insert() count (which is "+std::to_string(count)+") is more than the remaining max_size");
+			}
+			if (count <= dataCapacity - dataSize && isElement(value)) {
+				value_type copy(value);
+				return insert(cbegin() + index, count, copy);
+			}
+			return insertElements(index, static_cast<size_type>(count), [&](pointer destination) {
+				constructCopies(destination, count, value);
+			});
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		iterator insert(const_iterator pos, InputIt first, InputIt last) {
+			const size_type index = pos - cbegin();
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				const std::size_t distance = std::distance(first, last);
+				if (distance > std::size_t(max_size() - dataSize)) {
+					throw std::length_error("compact_vector::insert() range is longer than the remaining max_size");
+				}
+				const size_type count = static_cast<size_type>(distance);
+				return insertElements(index, count, [&](pointer destination) {
+					constructRange(destination, first, count);
+				});
+			} else {
+				const size_type oldSize = dataSize;
+				while (first != last) {
+					emplace_back(*first);
+					++first;
+				}
+				std::rotate(dataBegin + index, dataBegin + oldSize, dataEnd());
+				return dataBegin + index;
+			}
+		}
+
+		iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+			return insert(pos, ilist.begin(), ilist.end());
+		}
+
+		template<class... Args>
+		iterator emplace(const_iterator pos, Args&&... args) {
+			const size_type index = pos - cbegin();
+			if (index == dataSize) {
+				emplace_back(std::forward<Args>(args)...);
+				return dataBegin + index;
+			}
+			if (dataSize == dataCapacity) {
+				return insertElements(index, 1, [&](pointer destination) {
+					allocatorTraits::construct(vectorAllocator(), destination, std::forward<Args>(args)...);
+				});
+			}
+			value_type temp(std::forward<Args>(args)...);
+			return insertElements(index, 1, [&](pointer destination) {
+				allocatorTraits::construct(vectorAllocator(), destination, std::move(temp));
+			});
+		}
+
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			pointer eraseBegin = dataBegin + (first - cbegin());
+			pointer eraseEnd = dataBegin + (last - cbegin());
+			if (eraseBegin != eraseEnd) {
+				if constexpr (is_trivially_relocatable_v<value_type>) {
+					destroyElements(eraseBegin, eraseEnd);
+					std::memmove(static_cast<void*>(eraseBegin), static_cast<const void*>(eraseEnd), (dataEnd() - eraseEnd) * sizeof(value_type));
+					dataSize -= static_cast<size_type>(eraseEnd - eraseBegin);
+				} else {
+					pointer newDataEnd = std::move(eraseEnd, dataEnd(), eraseBegin);
+					resizeDown(static_cast<size_type>(newDataEnd - dataBegin));
+				}
+			}
+			return eraseBegin;
+		}
+
+		iterator erase_unordered(const_iterator pos) {
+			pointer position = dataBegin + (pos - cbegin());
+			pointer last = dataEnd() - 1;
+			if (position != last) {
+				if constexpr (is_trivially_relocatable_v<value_type>) {
+					allocatorTraits::destroy(vectorAllocator(), position);
+					std::memcpy(static_cast<void*>(position), static_cast<const void*>(last), sizeof(value_type));
+					--dataSize;
+					return position;
+				} else {
+					*position = std::move(*last);
+				}
+			}
+			pop_back();
+			return position;
+		}
+
+		void push_back(const value_type &obj) {
+			emplace_back(obj);
+		}
+
+		void push_back(value_type &&obj) {
+			emplace_back(std::move(obj));
+		}
+
+		template<class... Args>
+		reference emplace_back(Args&&... args) {
+			if (dataSize == dataCapacity) {
+				//Construct in the new buffer before the old elements move away, args may refer to one of them
+				return *insertElements(dataSize, 1, [&](pointer destination) {
+					allocatorTraits::construct(vectorAllocator(), destination, std::forward<Args>(args)...);
+				});
+			}
+			allocatorTraits::construct(vectorAllocator(), dataEnd(), std::forward<Args>(args)...);
+			return dataBegin[dataSize++];
+		}
+
+		//Same as vector::push_back_unchecked, running out of capacity is checked only by assert
+		void push_back_unchecked(const value_type &obj) {
+			emplace_back_unchecked(obj);
+		}
+
+		void push_back_unchecked(value_type &&obj) {
+			emplace_back_unchecked(std::move(obj));
+		}
+
+		template<class... Args>
+		reference emplace_back_unchecked(Args&&... args) {
+			assert(dataSize != dataCapacity && "compact_vector::emplace_back_unchecked() without spare capacity");
+			allocatorTraits::construct(vectorAllocator(), dataEnd(), std::forward<Args>(args)...);
+			return dataBegin[dataSize++];
+		}
+
+		//Appends count elements, the i'th constructed from generator(i). Room is made once
+		template<class Generator>
+		void append_n(std::size_t count, Generator generator) {
+			if (count > std::size_t(max_size() - dataSize)) {
+				throw std::length_error("compact_vector::append_n() count (which is "+std::to_string(count)+") is more than the remaining max_size");
+			}
+			insertElements(dataSize, static_cast<size_type>(count), [&](pointer destination) {
+				size_type constructed = 0;
+				try {
+					for (; constructed<count; ++constructed) {
+						allocatorTraits::construct(vectorAllocator(), destination + constructed, generator(constructed));
+					}
+				} catch (...) {
+					destroyElements(destination, destination + constructed);
+					throw;
+				}
+			});
+		}
+
+		//Appends the elements of range, which may be part of this vector. Forward ranges make room once
+		template<class Range>
+		void append_range(Range &&range) {
+			insert(end(), std::begin(range), std::end(range));
+		}
+
+		void pop_back() {
+			--dataSize;
+			allocatorTraits::destroy(vectorAllocator(), dataEnd());
+		}
+
+		void resize(std::size_t requestedSize) {
+			const size_type count = checkedSize(requestedSize, "compact_vector::resize()");
+			if (dataSize < count) {
+				reallocateToNewSizeIfNecessary(count);
+				for (; dataSize<count; ++dataSize) {
+					allocatorTraits::construct(vectorAllocator(), dataEnd());
+				}
+			} else {
+				resizeDown(count);
+			}
+		}
+
+		void resize(std::size_t requestedSize, const value_type &value) {
+			const size_type count = checkedSize(requestedSize, "compact_vector::resize()");
+			if (dataSize < count) {
+				if (isElement(value)) {
+					value_type copy(value);
+					resize(count, copy);
+					return;
+				}
+				reallocateToNewSizeIfNecessary(count);
+				for (; dataSize<count; ++dataSize) {
+					allocatorTraits::construct(vectorAllocator(), dataEnd(), value);
+				}
+			} else {
+				resizeDown(count);
+			}
+		}
+
+		void resize_for_overwrite(std::size_t requestedSize) {
+			const size_type count = checkedSize(requestedSize, "compact_vector::resize_for_overwrite()");
+			if (dataSize < count) {
+				growDefaultInitialized(count);
+			} else {
+				resizeDown(count);
+			}
+		}
+
+		template<class Operation>
+		void resize_and_overwrite(std::size_t requestedSize, Operation op) {
+			const size_type count = checkedSize(requestedSize, "compact_vector::resize_and_overwrite()");
+			resize_for_overwrite(count);
+			const std::size_t newSize = std::move(op)(data(), count);
+			assert(newSize <= count && "compact_vector::resize_and_overwrite() op returned more than count");
+			resizeDown(static_cast<size_type>(newSize));
+		}
+
+		void swap(compact_vector &other) noexcept(allocatorTraits::propagate_on_container_swap::value || allocatorTraits::is_always_equal::value) {
+			if (typename allocatorTraits::propagate_on_container_swap()) {
+				//Exchange allocators
+				using std::swap;
+				swap(vectorAllocator(), other.vectorAllocator());
+			}
+			std::swap(dataBegin, other.dataBegin);
+			std::swap(dataSize, other.dataSize);
+			std::swap(dataCapacity, other.dataCapacity);
+		}
+	};
+
+	template<class T, class Alloc, class Growth>
+	bool operator==(const compact_vector<T, Alloc, Growth> &left, const compact_vector<T, Alloc, Growth> &right) {
+		if (left.size() != right.size()) {
+			return false;
+		}
+		return detail::elementsEqual(left.data(), right.data(), left.size());
+	}
+
+	template<class T, class Alloc, class Growth>
+	bool operator!=(const compact_vector<T, Alloc, Growth> &left, const compact_vector<T, Alloc, Growth> &right) {
+		return !(left == right);
+	}
+
+	template<class T, class Alloc, class Growth>
+	bool operator<(const compact_vector<T, Alloc, Growth> &left, const compact_vector<T, Alloc, Growth> &right) {
+		return detail::lexicographicallyLess(left.data(), left.size(), right.data(), right.size());
+	}
+
+	template<class T, class Alloc, class Growth>
+	bool operator<=(const compact_vector<T, Alloc, Growth> &left, const compact_vector<T, Alloc, Growth> &right) {
+		return !(right < left);
+	}
+
+	template<class T, class Alloc, class Growth>
+	bool operator>(const compact_vector<T, Alloc, Growth> &left, const compact_vector<T, Alloc, Growth> &right) {
+		return right < left;
+	}
+
+	template<class T, class Alloc, class Growth>
+	bool operator>=(const compact_vector<T, Alloc, Growth> &left, const compact_vector<T, Alloc, Growth> &right) {
+		return !(left < right);
+	}
+
+	template<class T, class Alloc, class Growth>
+	void swap(compact_vector<T, Alloc, Growth> &left, compact_vector<T, Alloc, Growth> &right) noexcept(noexcept(left.swap(right))) {
+		left.swap(right);
+	}
+
+	template<class T, class Alloc, class Growth, class Pred>
+	typename compact_vector<T, Alloc, Growth>::size_type erase_if(compact_vector<T, Alloc, Growth> &v, Pred pred) {
+		auto newEnd = std::remove_if(v.begin(), v.end(), pred);
+		const typename compact_vector<T, Alloc, Growth>::size_type erasedCount = static_cast<typename compact_vector<T, Alloc, Growth>::size_type>(v.end() - newEnd);
+		v.erase(newEnd, v.end());
+		return erasedCount;
+	}
+
+	template<class T, class Alloc, class Growth, class U>
+	typename compact_vector<T, Alloc, Growth>::size_type erase(compact_vector<T, Alloc, Growth> &v, const U &value) {
+		return erase_if(v, [&value](const T &element) {
+			return element == value;
+		});
+	}
+}
+
+#endif //COMPACT_VECTOR_HPP
@@ -0,0 +1,432 @@
+#ifndef CONCURRENT_VECTOR_HPP
+#define CONCURRENT_VECTOR_HPP 1
+
+#include <atomic>
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//A vector that any number of threads can append to at once without a lock
+	//push_back/emplace_back claim a slot with a compare-and-swap once the segment holding it exists, so a
+	//	failed segment allocation claims nothing. Elements live in segments that double in size and are
+	//	never moved, so growing never invalidates references, iterators or reads of existing elements.
+	//	Missing segments are installed with a compare-and-swap, the loser frees its copy
+	//size() only counts slots whose construction has finished, along with every slot before them, so
+	//	reading any index below size() is safe while other threads keep appending. Whichever thread
+	//	finishes a slot moves size() past every finished slot that follows it
+	//A claimed slot can't be given back without a lock, so a slot whose constructor threw stays empty. It
+	//	is counted by size() but holds no element: at() throws for it, has_element() is false and
+	//	iteration and freeze() skip it
+	//Everything other than push_back, emplace_back, reserve and reading elements must not run
+	//	concurrently with other calls
+	template<class Type, class Allocator = std::allocator<Type>, std::size_t FirstSegmentSize = 8>
+	class concurrent_vector {
+	private:
+		enum class slot_state : unsigned char {
+			empty,				//Claimed (or not yet claimed) and still being constructed
+			constructed,
+			failed				//The constructor threw, there is no element
+		};
+
+		//Walks the slots of a concurrent_vector in order, skipping those that hold no element
+		template<class Container, class Value>
+		class element_iterator {
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type 				= std::remove_const_t<Value>;
+			using difference_type 	= std::ptrdiff_t;
+			using pointer 					= Value*;
+			using reference 				= Value&;
+
+			element_iterator() = default;
+
+			//iterator -> const_iterator
+			template<class OtherContainer, class OtherValue, typename = std::enable_if_t<std::is_convertible<OtherValue*, Value*>::value>>
+			element_iterator(const element_iterator<OtherContainer, OtherValue> &other) : container(other.container), index(other.index) {}
+
+			reference operator*() const {
+				return (*container)[index];
+			}
+
+			pointer operator->() const {
+				return std::addressof((*container)[index]);
+			}
+
+			element_iterator& operator++() {
+				const std::size_t end = container->size();
+				do {
+					++index;
+				} while (index < end && !container->has_element(index));
+				return *this;
+			}
+
+			element_iterator operator++(int) {
+				element_iterator copy(*this);
+				++*this;
+				return copy;
+			}
+
+			element_iterator& operator--() {
+				do {
+					--index;
+				} while (!container->has_element(index));
+				return *this;
+			}
+
+			element_iterator operator--(int) {
+				element_iterator copy(*this);
+				--*this;
+				return copy;
+			}
+
+			friend bool operator==(const element_iterator &left, const element_iterator &right) {
+				return left.index == right.index;
+			}
+
+			friend bool operator!=(const element_iterator &left, const element_iterator &right) {
+				return left.index != right.index;
+			}
+
+			//The index of the slot this iterator refers to
+			std::size_t slot() const {
+				return index;
+			}
+
+		private:
+			template<class, class>
+			friend class element_iterator;
+			friend class concurrent_vector;
+
+			//index must be end or a slot holding an element
+			element_iterator(Container *container, std::size_t index) : container(container), index(index) {}
+
+			Container *container{nullptr};
+			std::size_t index{0};
+		};
+
+	public:
+		using allocator_type 	= Allocator;
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= typename std::allocator_traits<Allocator>::pointer;
+		using const_pointer 	= typename std::allocator_traits<Allocator>::const_pointer;
+		using iterator 				= element_iterator<concurrent_vector, Type>;
+		using const_iterator 	= element_iterator<const concurrent_vector, const Type>;
+
+	private:
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		using stateAllocator = typename allocatorTraits::template rebind_alloc<std::atomic<slot_state>>;
+		using stateAllocatorTraits = std::allocator_traits<stateAllocator>;
+		using statePointer = typename stateAllocatorTraits::pointer;
+		using segments = detail::geometric_segments<FirstSegmentSize>;
+		allocator_type vectorAllocator;
+		//Slots handed out to appending threads
+		std::atomic<size_type> claimedSize{0};
+		//Slots that are finished, along with every slot before them
+		std::atomic<size_type> publishedSize{0};
+		std::atomic<pointer> segmentTable[segments::SEGMENT_COUNT] = {};
+		std::atomic<statePointer> stateTable[segments::SEGMENT_COUNT] = {};
+
+		//Returns the segment, allocating it and its slot states if no other thread has yet
+		pointer segmentFor(size_type segment) {
+			pointer data = segmentTable[segment].load(std::memory_order_acquire);
+			if (data != nullptr) {
+				return data;
+			}
+			statesFor(segment);
+			pointer newData = allocatorTraits::allocate(vectorAllocator, segments::segmentSize(segment));
+			if (segmentTable[segment].compare_exchange_strong(data, newData, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return newData;
+			}
+			//Another thread installed it first
+			allocatorTraits::deallocate(vectorAllocator, newData, segments::segmentSize(segment));
+			return data;
+		}
+
+		statePointer statesFor(size_type segment) {
+			statePointer states = stateTable[segment].load(std::memory_order_acquire);
+			if (states != nullptr) {
+				return states;
+			}
+			stateAllocator allocator(vectorAllocator);
+			const size_type segmentSize = segments::segmentSize(segment);
+			statePointer newStates = stateAllocatorTraits::allocate(allocator, segmentSize);
+			for (size_type i=0; i<segmentSize; ++i) {
+				::new (static_cast<void*>(std::addressof(newStates[i]))) std::atomic<slot_state>(slot_state::empty);
+			}
+			if (stateTable[segment].compare_exchange_strong(states, newStates, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return newStates;
+			}
+			stateAllocatorTraits::deallocate(allocator, newStates, segmentSize);
+			return states;
+		}
+
+		pointer elementAddress(size_type index) const {
+			const size_type segment = segments::segmentOf(index);
+			return segmentTable[segment].load(std::memory_order_acquire) + segments::offsetInSegment(index, segment);
+		}
+
+		std::atomic<slot_state>& stateOf(size_type index) const {
+			const size_type segment = segments::segmentOf(index);
+			return stateTable[segment].load(std::memory_order_acquire)[segments::offsetInSegment(index, segment)];
+		}
+
+		//Records how the slot at index ended up and moves publishedSize past every finished slot
+		void finishSlot(size_type index, slot_state state) {
+			//seq_cst so that either this thread sees the slot publishedSize is waiting on as finished,
+			//	or the thread that finishes that slot sees this one
+			stateOf(index).store(state, std::memory_order_seq_cst);
+			size_type published = publishedSize.load(std::memory_order_seq_cst);
+			while (published < claimedSize.load(std::memory_order_seq_cst) && stateOf(published).load(std::memory_order_seq_cst) != slot_state::empty) {
+				if (publishedSize.compare_exchange_weak(published, published + 1, std::memory_order_seq_cst)) {
+					++published;
+				}
+			}
+		}
+
+		void releaseSegments() {
+			stateAllocator allocator(vectorAllocator);
+			for (size_type segment=0; segment<segments::SEGMENT_COUNT; ++segment) {
+				pointer data = segmentTable[segment].load(std::memory_order_relaxed);
+				if (data != nullptr) {
+					allocatorTraits::deallocate(vectorAllocator, data, segments::segmentSize(segment));
+					segmentTable[segment].store(nullptr, std::memory_order_relaxed);
+				}
+				statePointer states = stateTable[segment].load(std::memory_order_relaxed);
+				if (states != nullptr) {
+					stateAllocatorTraits::deallocate(allocator, states, segments::segmentSize(segment));
+					stateTable[segment].store(nullptr, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		//The first slot at or after index that holds an element, or size()
+		size_type firstElementFrom(size_type index) const {
+			const size_type end = size();
+			while (index < end && !has_element(index)) {
+				++index;
+			}
+			return index;
+		}
+
+	public:
+		concurrent_vector() : concurrent_vector(Allocator()) {}
+
+		explicit concurrent_vector(const Allocator &alloc) : vectorAllocator(alloc) {}
+
+		//Neither copying nor moving can be made safe against concurrent appends
+		concurrent_vector(const concurrent_vector &other) = delete;
+		concurrent_vector& operator=(const concurrent_vector &other) = delete;
+
+		~concurrent_vector() {
+			clear();
+			releaseSegments();
+		}
+
+		allocator_type get_allocator() const {
+			return vectorAllocator;
+		}
+
+		//False for a slot whose construction threw
+		bool has_element(size_type pos) const {
+			return stateOf(pos).load(std::memory_order_acquire) == slot_state::constructed;
+		}
+
+		reference at(size_type pos) {
+			if (pos >= size()) {
+				throw std::out_of_range("concurrent_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			if (!has_element(pos)) {
+				throw std::out_of_range("concurrent_vector::at() pos (which is "+std::to_string(pos)+") holds no element, its construction threw");
+			}
+			return *elementAddress(pos);
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= size()) {
+				throw std::out_of_range("concurrent_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			if (!has_element(pos)) {
+				throw std::out_of_range("concurrent_vector::at() pos (which is "+std::to_string(pos)+") holds no element, its construction threw");
+			}
+			return *elementAddress(pos);
+		}
+
+		reference operator[](size_type pos) {
+			return *elementAddress(pos);
+		}
+
+		const_reference operator[](size_type pos) const {
+			return *elementAddress(pos);
+		}
+
+		reference front() {
+			return *begin();
+		}
+
+		const_reference front() const {
+			return *begin();
+		}
+
+		reference back() {
+			return *--end();
+		}
+
+		const_reference back() const {
+			return *--end();
+		}
+
+		iterator begin() {
+			return iterator(this, firstElementFrom(0));
+		}
+
+		const_iterator begin() const {
+			return const_iterator(this, firstElementFrom(0));
+		}
+
+		const_iterator cbegin() const {
+			return begin();
+		}
+
+		iterator end() {
+			return iterator(this, size());
+		}
+
+		const_iterator end() const {
+			return const_iterator(this, size());
+		}
+
+		const_iterator cend() const {
+			return end();
+		}
+
+		bool empty() const {
+			return size() == 0;
+		}
+
+		size_type size() const {
+			return publishedSize.load(std::memory_order_acquire);
+		}
+
+		size_type max_size() const {
+			return std::min<size_type>(allocatorTraits::max_size(vectorAllocator), std::numeric_limits<size_type>::max() - FirstSegmentSize);
+		}
+
+		//Elements that fit in the segments allocated so far
+		size_type capacity() const {
+			size_type segment = 0;
+			while (segment < segments::SEGMENT_COUNT && segmentTable[segment].load(std::memory_order_acquire) != nullptr) {
+				++segment;
+			}
+			return segments::segmentBegin(segment);
+		}
+
+		//Allocates every segment needed to hold newCapacity elements
+		void reserve(size_type newCapacity) {
+			if (newCapacity > max_size()) {
+				throw std::length_error("concurrent_vector::reserve() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			if (newCapacity == 0) {
+				return;
+			}
+			const size_type lastSegment = segments::segmentOf(newCapacity - 1);
+			for (size_type segment=0; segment<=lastSegment; ++segment) {
+				segmentFor(segment);
+			}
+		}
+
+		//Destroys every element but keeps the segments
+		void clear() {
+			const size_type oldSize = claimedSize.load(std::memory_order_acquire);
+			for (size_type i=0; i<oldSize; ++i) {
+				std::atomic<slot_state> &state = stateOf(i);
+				if constexpr (!std::is_trivially_destructible<value_type>::value) {
+					if (state.load(std::memory_order_relaxed) == slot_state::constructed) {
+						allocatorTraits::destroy(vectorAllocator, elementAddress(i));
+					}
+				}
+				state.store(slot_state::empty, std::memory_order_relaxed);
+			}
+			publishedSize.store(0, std::memory_order_release);
+			claimedSize.store(0, std::memory_order_release);
+		}
+
+		//Returns an iterator to the new element, whose index no other thread will be given
+		iterator push_back(const value_type &obj) {
+			return claimAndConstruct(obj);
+		}
+
+		iterator push_back(value_type &&obj) {
+			return claimAndConstruct(std::move(obj));
+		}
+
+		template<class... Args>
+		reference emplace_back(Args&&... args) {
+			return *claimAndConstruct(std::forward<Args>(args)...);
+		}
+
+		//Moves every element into a contiguous vector, leaving this one empty
+		//	Must only be called once production has ended
+		vector<Type, Allocator> freeze() {
+			const size_type slotCount = size();
+			size_type elementCount = 0;
+			for (size_type i=0; i<slotCount; ++i) {
+				elementCount += has_element(i);
+			}
+			vector<Type, Allocator> result(vectorAllocator);
+			if constexpr (std::is_trivially_copyable<value_type>::value) {
+				result.resize_for_overwrite(elementCount);
+				//Copy runs of elements a segment at a time, stopping at empty slots
+				size_type copied = 0;
+				for (size_type segment=0; segment<segments::SEGMENT_COUNT && segments::segmentBegin(segment)<slotCount; ++segment) {
+					const size_type segmentEnd = std::min(segments::segmentBegin(segment) + segments::segmentSize(segment), slotCount);
+					size_type runBegin = segments::segmentBegin(segment);
+					while (runBegin < segmentEnd) {
+						size_type runEnd = runBegin;
+						while (runEnd < segmentEnd && has_element(runEnd)) {
+							++runEnd;
+						}
+						std::memcpy(static_cast<void*>(result.data() + copied), static_cast<const void*>(elementAddress(runBegin)), (runEnd - runBegin) * sizeof(value_type));
+						copied += runEnd - runBegin;
+						runBegin = runEnd + 1;
+					}
+				}
+			} else {
+				result.reserve(elementCount);
+				for (auto &element : *this) {
+					result.emplace_back(std::move(element));
+				}
+			}
+			clear();
+			releaseSegments();
+			return result;
+		}
+
+	private:
+		//Claims the next slot and constructs the element in it
+		template<class... Args>
+		iterator claimAndConstruct(Args&&... args) {
+			//The segment is allocated before the slot is claimed, if that throws size() hasn't changed
+			size_type index = claimedSize.load(std::memory_order_acquire);
+			pointer segmentData;
+			do {
+				segmentData = segmentFor(segments::segmentOf(index));
+			} while (!claimedSize.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+			pointer element = segmentData + segments::offsetInSegment(index, segments::segmentOf(index));
+			try {
+				allocatorTraits::construct(vectorAllocator, element, std::forward<Args>(args)...);
+			} catch (...) {
+				//The slot stays in the vector without an element
+				finishSlot(index, slot_state::failed);
+				throw;
+			}
+			finishSlot(index, slot_state::constructed);
+			return iterator(this, index);
+		}
+	};
+}
+
+#endif //CONCURRENT_VECTOR_HPP
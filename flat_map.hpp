@@ -0,0 +1,599 @@
+#ifndef FLAT_MAP_HPP
+#define FLAT_MAP_HPP 1
+
+#include <functional>
+#include <tuple>
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//Passed to a constructor or insert() whose input is already sorted (and, for the unique containers,
+	//	free of repeated keys), so the sort can be skipped
+	struct sorted_unique_t {
+		explicit sorted_unique_t() = default;
+	};
+	inline constexpr sorted_unique_t sorted_unique{};
+
+	struct sorted_equivalent_t {
+		explicit sorted_equivalent_t() = default;
+	};
+	inline constexpr sorted_equivalent_t sorted_equivalent{};
+
+	namespace detail {
+
+		//The first element in [first, first + count) for which isBefore is false, the range must be
+		//	partitioned by it
+		//The loop has no data dependent branch, the comparison only picks the next base (a conditional
+		//	move), so there are no mispredictions to pay for and the trip count depends on count alone
+		template<class RandomIt, class Predicate>
+		RandomIt branchlessPartitionPoint(RandomIt first, std::size_t count, Predicate isBefore) {
+			while (count > 1) {
+				const std::size_t half = count / 2;
+				first = (isBefore(first[half]) ? first + half : first);
+				count -= half;
+			}
+			return first + static_cast<std::size_t>(count == 1 && isBefore(*first));
+		}
+
+		struct identity_key {
+			template<class Type>
+			const Type& operator()(const Type &value) const {
+				return value;
+			}
+		};
+
+		struct first_key {
+			template<class Pair>
+			const typename Pair::first_type& operator()(const Pair &value) const {
+				return value.first;
+			}
+		};
+
+		//A sorted vector of values, the storage behind flat_set, flat_map and flat_multimap
+		//Lookups are binary searches over contiguous memory. Inserting or erasing shifts the elements
+		//	after the position, which is a memmove for trivially relocatable values
+		template<class Key, class Value, class KeyOf, class Compare, class Allocator, bool Unique, bool MutableValues>
+		class flat_tree {
+		public:
+			using key_type 				= Key;
+			using value_type 			= Value;
+			using key_compare 		= Compare;
+			using allocator_type 	= Allocator;
+			using container_type 	= vector<Value, Allocator>;
+			using size_type 			= typename container_type::size_type;
+			using difference_type = typename container_type::difference_type;
+			using reference 			= Value&;
+			using const_reference = const Value&;
+			using const_iterator 	= typename container_type::const_iterator;
+			using iterator 				= std::conditional_t<MutableValues, typename container_type::iterator, const_iterator>;
+			using reverse_iterator 				= std::reverse_iterator<iterator>;
+			using const_reverse_iterator 	= std::reverse_iterator<const_iterator>;
+			using sorted_tag 			= std::conditional_t<Unique, sorted_unique_t, sorted_equivalent_t>;
+			using insert_return_type = std::conditional_t<Unique, std::pair<iterator, bool>, iterator>;
+
+			class value_compare {
+			public:
+				bool operator()(const value_type &left, const value_type &right) const {
+					return compare(KeyOf()(left), KeyOf()(right));
+				}
+
+			private:
+				friend class flat_tree;
+				value_compare(const key_compare &compare) : compare(compare) {}
+				key_compare compare;
+			};
+
+		protected:
+			container_type elements;
+			key_compare keyCompare;
+
+			static const key_type& keyOf(const value_type &value) {
+				return KeyOf()(value);
+			}
+
+			size_type lowerBoundIndex(const key_type &key) const {
+				return branchlessPartitionPoint(elements.begin(), elements.size(), [&](const value_type &value) {
+					return keyCompare(keyOf(value), key);
+				}) - elements.begin();
+			}
+
+			size_type upperBoundIndex(const key_type &key) const {
+				return branchlessPartitionPoint(elements.begin(), elements.size(), [&](const value_type &value) {
+					return !keyCompare(key, keyOf(value));
+				}) - elements.begin();
+			}
+
+			bool isKeyAt(size_type index, const key_type &key) const {
+				return index != elements.size() && !keyCompare(key, keyOf(elements[index]));
+			}
+
+			iterator iteratorAt(size_type index) {
+				return begin() + index;
+			}
+
+			bool isSorted() const {
+				if constexpr (Unique) {
+					return std::adjacent_find(elements.begin(), elements.end(), [&](const value_type &left, const value_type &right) {
+						return !keyCompare(keyOf(left), keyOf(right));
+					}) == elements.end();
+				} else {
+					return std::is_sorted(elements.begin(), elements.end(), value_comp());
+				}
+			}
+
+			//Sorts the elements from sortedCount on and merges them into the sorted ones before them
+			//	Stable, so when keys are unique the first of each run of equal keys is the one kept
+			void mergeUnsorted(size_type sortedCount, bool tailSorted) {
+				const auto middle = elements.begin() + sortedCount;
+				if (!tailSorted) {
+					std::stable_sort(middle, elements.end(), value_comp());
+				}
+				std::inplace_merge(elements.begin(), middle, elements.end(), value_comp());
+				if constexpr (Unique) {
+					auto newEnd = std::unique(elements.begin(), elements.end(), [&](const value_type &left, const value_type &right) {
+						return !keyCompare(keyOf(left), keyOf(right));
+					});
+					elements.erase(newEnd, elements.end());
+				}
+			}
+
+			template<class InputIt>
+			void appendAndMerge(InputIt first, InputIt last, bool sorted) {
+				const size_type sortedCount = elements.size();
+				elements.insert(elements.end(), first, last);
+				mergeUnsorted(sortedCount, sorted);
+			}
+
+			//Constructs a value at index, which the caller has checked keeps the order
+			template<class... Args>
+			iterator emplaceAt(size_type index, Args&&... args) {
+				elements.emplace(elements.begin() + index, std::forward<Args>(args)...);
+				return iteratorAt(index);
+			}
+
+		public:
+			flat_tree() : flat_tree(Compare()) {}
+
+			explicit flat_tree(const Compare &compare, const Allocator &alloc = Allocator()) : elements(alloc), keyCompare(compare) {}
+
+			explicit flat_tree(const Allocator &alloc) : elements(alloc) {}
+
+			//Sorts the values and, when keys are unique, keeps the first of each run of equal keys
+			explicit flat_tree(container_type values, const Compare &compare = Compare()) : elements(std::move(values)), keyCompare(compare) {
+				mergeUnsorted(0, false);
+			}
+
+			flat_tree(sorted_tag, container_type values, const Compare &compare = Compare()) : elements(std::move(values)), keyCompare(compare) {
+				assert(isSorted() && "flat_tree::flat_tree() sorted input isn't sorted");
+			}
+
+			template<class InputIt, typename = std::enable_if_t<
+															std::is_base_of<
+																std::input_iterator_tag,
+																typename std::iterator_traits<InputIt>::iterator_category
+															>::value,
+															InputIt
+														>>
+			flat_tree(InputIt first, InputIt last, const Compare &compare = Compare(), const Allocator &alloc = Allocator()) : elements(first, last, alloc), keyCompare(compare) {
+				mergeUnsorted(0, false);
+			}
+
+			template<class InputIt, typename = std::enable_if_t<
+															std::is_base_of<
+																std::input_iterator_tag,
+																typename std::iterator_traits<InputIt>::iterator_category
+															>::value,
+															InputIt
+														>>
+			flat_tree(sorted_tag, InputIt first, InputIt last, const Compare &compare = Compare(), const Allocator &alloc = Allocator()) : elements(first, last, alloc), keyCompare(compare) {
+				assert(isSorted() && "flat_tree::flat_tree() sorted input isn't sorted");
+			}
+
+			flat_tree(std::initializer_list<value_type> ilist, const Compare &compare = Compare(), const Allocator &alloc = Allocator()) : flat_tree(ilist.begin(), ilist.end(), compare, alloc) {}
+
+			flat_tree(sorted_tag tag, std::initializer_list<value_type> ilist, const Compare &compare = Compare(), const Allocator &alloc = Allocator()) : flat_tree(tag, ilist.begin(), ilist.end(), compare, alloc) {}
+
+			flat_tree& operator=(std::initializer_list<value_type> ilist) {
+				elements.assign(ilist);
+				mergeUnsorted(0, false);
+				return *this;
+			}
+
+			allocator_type get_allocator() const {
+				return elements.get_allocator();
+			}
+
+			iterator begin() {
+				return elements.begin();
+			}
+
+			const_iterator begin() const {
+				return elements.begin();
+			}
+
+			const_iterator cbegin() const {
+				return elements.cbegin();
+			}
+
+			iterator end() {
+				return elements.end();
+			}
+
+			const_iterator end() const {
+				return elements.end();
+			}
+
+			const_iterator cend() const {
+				return elements.cend();
+			}
+
+			reverse_iterator rbegin() {
+				return reverse_iterator(end());
+			}
+
+			const_reverse_iterator rbegin() const {
+				return const_reverse_iterator(end());
+			}
+
+			reverse_iterator rend() {
+				return reverse_iterator(begin());
+			}
+
+			const_reverse_iterator rend() const {
+				return const_reverse_iterator(begin());
+			}
+
+			bool empty() const {
+				return elements.empty();
+			}
+
+			size_type size() const {
+				return elements.size();
+			}
+
+			size_type max_size() const {
+				return elements.max_size();
+			}
+
+			size_type capacity() const {
+				return elements.capacity();
+			}
+
+			void reserve(size_type newCapacity) {
+				elements.reserve(newCapacity);
+			}
+
+			void shrink_to_fit() {
+				elements.shrink_to_fit();
+			}
+
+			void clear() {
+				elements.clear();
+			}
+
+			template<class... Args>
+			insert_return_type emplace(Args&&... args) {
+				value_type value(std::forward<Args>(args)...);
+				if constexpr (Unique) {
+					const size_type index = lowerBoundIndex(keyOf(value));
+					if (isKeyAt(index, keyOf(value))) {
+						return {iteratorAt(index), false};
+					}
+					return {emplaceAt(index, std::move(value)), true};
+				} else {
+					return emplaceAt(upperBoundIndex(keyOf(value)), std::move(value));
+				}
+			}
+
+			//Inserts right before hint without searching if that keeps the order, which makes filling
+			//	from sorted input linear
+			template<class... Args>
+			iterator emplace_hint(const_iterator hint, Args&&... args) {
+				value_type value(std::forward<Args>(args)...);
+				const key_type &key = keyOf(value);
+				const size_type index = hint - cbegin();
+				if constexpr (Unique) {
+					const bool afterPrevious = (index == 0 || keyCompare(keyOf(elements[index - 1]), key));
+					const bool beforeHint = (index == size() || keyCompare(key, keyOf(elements[index])));
+					if (afterPrevious && beforeHint) {
+						return emplaceAt(index, std::move(value));
+					}
+					if (afterPrevious && index != size() && !keyCompare(keyOf(elements[index]), key)) {
+						//Already there
+						return iteratorAt(index);
+					}
+					return emplace(std::move(value)).first;
+				} else {
+					const bool afterPrevious = (index == 0 || !keyCompare(key, keyOf(elements[index - 1])));
+					const bool beforeHint = (index == size() || !keyCompare(keyOf(elements[index]), key));
+					if (afterPrevious && beforeHint) {
+						return emplaceAt(index, std::move(value));
+					}
+					return emplace(std::move(value));
+				}
+			}
+
+			insert_return_type insert(const value_type &value) {
+				return emplace(value);
+			}
+
+			insert_return_type insert(value_type &&value) {
+				return emplace(std::move(value));
+			}
+
+			iterator insert(const_iterator hint, const value_type &value) {
+				return emplace_hint(hint, value);
+			}
+
+			iterator insert(const_iterator hint, value_type &&value) {
+				return emplace_hint(hint, std::move(value));
+			}
+
+			//Appends the range, sorts it and merges it in, which beats inserting one at a time once the
+			//	range is more than a handful of elements
+			template<class InputIt, typename = std::enable_if_t<
+															std::is_base_of<
+																std::input_iterator_tag,
+																typename std::iterator_traits<InputIt>::iterator_category
+															>::value,
+															InputIt
+														>>
+			void insert(InputIt first, InputIt last) {
+				appendAndMerge(first, last, false);
+			}
+
+			template<class InputIt, typename = std::enable_if_t<
+															std::is_base_of<
+																std::input_iterator_tag,
+																typename std::iterator_traits<InputIt>::iterator_category
+															>::value,
+															InputIt
+														>>
+			void insert(sorted_tag, InputIt first, InputIt last) {
+				appendAndMerge(first, last, true);
+			}
+
+			void insert(std::initializer_list<value_type> ilist) {
+				insert(ilist.begin(), ilist.end());
+			}
+
+			iterator erase(const_iterator pos) {
+				return elements.erase(pos);
+			}
+
+			iterator erase(const_iterator first, const_iterator last) {
+				return elements.erase(first, last);
+			}
+
+			size_type erase(const key_type &key) {
+				const size_type first = lowerBoundIndex(key);
+				const size_type last = upperBoundIndex(key);
+				elements.erase(elements.begin() + first, elements.begin() + last);
+				return last - first;
+			}
+
+			//Moves the sorted values out, leaving this empty
+			container_type extract() {
+				container_type result(std::move(elements));
+				elements.clear();
+				return result;
+			}
+
+			//Takes over values, which must already be sorted (and free of repeated keys when they must be
+			//	unique). Only checked by assert
+			void replace(container_type &&values) {
+				elements = std::move(values);
+				assert(isSorted() && "flat_tree::replace() values aren't sorted");
+			}
+
+			void swap(flat_tree &other) noexcept(std::is_nothrow_swappable<container_type>::value && std::is_nothrow_swappable<key_compare>::value) {
+				using std::swap;
+				swap(elements, other.elements);
+				swap(keyCompare, other.keyCompare);
+			}
+
+			key_compare key_comp() const {
+				return keyCompare;
+			}
+
+			value_compare value_comp() const {
+				return value_compare(keyCompare);
+			}
+
+			iterator find(const key_type &key) {
+				const size_type index = lowerBoundIndex(key);
+				return (isKeyAt(index, key) ? iteratorAt(index) : end());
+			}
+
+			const_iterator find(const key_type &key) const {
+				const size_type index = lowerBoundIndex(key);
+				return (isKeyAt(index, key) ? begin() + index : end());
+			}
+
+			size_type count(const key_type &key) const {
+				if constexpr (Unique) {
+					return (contains(key) ? 1 : 0);
+				} else {
+					return upperBoundIndex(key) - lowerBoundIndex(key);
+				}
+			}
+
+			bool contains(const key_type &key) const {
+				return isKeyAt(lowerBoundIndex(key), key);
+			}
+
+			iterator lower_bound(const key_type &key) {
+				return iteratorAt(lowerBoundIndex(key));
+			}
+
+			const_iterator lower_bound(const key_type &key) const {
+				return begin() + lowerBoundIndex(key);
+			}
+
+			iterator upper_bound(const key_type &key) {
+				return iteratorAt(upperBoundIndex(key));
+			}
+
+			const_iterator upper_bound(const key_type &key) const {
+				return begin() + upperBoundIndex(key);
+			}
+
+			std::pair<iterator, iterator> equal_range(const key_type &key) {
+				return {lower_bound(key), upper_bound(key)};
+			}
+
+			std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
+				return {lower_bound(key), upper_bound(key)};
+			}
+
+			friend bool operator==(const flat_tree &left, const flat_tree &right) {
+				return left.elements == right.elements;
+			}
+
+			friend bool operator!=(const flat_tree &left, const flat_tree &right) {
+				return !(left == right);
+			}
+
+			friend bool operator<(const flat_tree &left, const flat_tree &right) {
+				return left.elements < right.elements;
+			}
+
+			friend bool operator<=(const flat_tree &left, const flat_tree &right) {
+				return !(right < left);
+			}
+
+			friend bool operator>(const flat_tree &left, const flat_tree &right) {
+				return right < left;
+			}
+
+			friend bool operator>=(const flat_tree &left, const flat_tree &right) {
+				return !(left < right);
+			}
+		};
+	}
+
+	//A sorted set of unique keys kept in a sandsnip3r::vector
+	//Compared to std::set, lookups touch a few contiguous cache lines instead of chasing node pointers and
+	//	there is one allocation instead of one per element. Inserting and erasing are O(n) since later
+	//	elements shift, so fill it in bulk (the range constructor or range insert) where possible
+	template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+	class flat_set : public detail::flat_tree<Key, Key, detail::identity_key, Compare, Allocator, true, false> {
+		using base = detail::flat_tree<Key, Key, detail::identity_key, Compare, Allocator, true, false>;
+	public:
+		using base::base;
+		using base::operator=;
+
+		friend void swap(flat_set &left, flat_set &right) noexcept(noexcept(left.swap(right))) {
+			left.swap(right);
+		}
+	};
+
+	//A sorted map with unique keys kept in a sandsnip3r::vector of key/value pairs, see flat_set
+	//The pairs are reachable through iterators, keys must not be changed through them
+	template<class Key, class T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<Key, T>>>
+	class flat_map : public detail::flat_tree<Key, std::pair<Key, T>, detail::first_key, Compare, Allocator, true, true> {
+		using base = detail::flat_tree<Key, std::pair<Key, T>, detail::first_key, Compare, Allocator, true, true>;
+	public:
+		using mapped_type = T;
+		using typename base::key_type;
+		using typename base::size_type;
+		using typename base::iterator;
+		using typename base::const_iterator;
+
+		using base::base;
+		using base::operator=;
+
+		T& at(const key_type &key) {
+			const size_type index = this->lowerBoundIndex(key);
+			if (!this->isKeyAt(index, key)) {
+				throw std::out_of_range("flat_map::at() key not found");
+			}
+			return this->elements[index].second;
+		}
+
+		const T& at(const key_type &key) const {
+			const size_type index = this->lowerBoundIndex(key);
+			if (!this->isKeyAt(index, key)) {
+				throw std::out_of_range("flat_map::at() key not found");
+			}
+			return this->elements[index].second;
+		}
+
+		T& operator[](const key_type &key) {
+			return try_emplace(key).first->second;
+		}
+
+		T& operator[](key_type &&key) {
+			return try_emplace(std::move(key)).first->second;
+		}
+
+		//Constructs the value from args only if key isn't present yet
+		template<class... Args>
+		std::pair<iterator, bool> try_emplace(const key_type &key, Args&&... args) {
+			return tryEmplace(key, std::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		std::pair<iterator, bool> try_emplace(key_type &&key, Args&&... args) {
+			return tryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template<class M>
+		std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&obj) {
+			auto result = try_emplace(key, std::forward<M>(obj));
+			if (!result.second) {
+				result.first->second = std::forward<M>(obj);
+			}
+			return result;
+		}
+
+		template<class M>
+		std::pair<iterator, bool> insert_or_assign(key_type &&key, M &&obj) {
+			auto result = try_emplace(std::move(key), std::forward<M>(obj));
+			if (!result.second) {
+				result.first->second = std::forward<M>(obj);
+			}
+			return result;
+		}
+
+		friend void swap(flat_map &left, flat_map &right) noexcept(noexcept(left.swap(right))) {
+			left.swap(right);
+		}
+
+	private:
+		template<class K, class... Args>
+		std::pair<iterator, bool> tryEmplace(K &&key, Args&&... args) {
+			const size_type index = this->lowerBoundIndex(key);
+			if (this->isKeyAt(index, key)) {
+				return {this->iteratorAt(index), false};
+			}
+			return {this->emplaceAt(index, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...)), true};
+		}
+	};
+
+	//A flat_map that allows repeated keys, values with equal keys stay in the order they were inserted
+	template<class Key, class T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<Key, T>>>
+	class flat_multimap : public detail::flat_tree<Key, std::pair<Key, T>, detail::first_key, Compare, Allocator, false, true> {
+		using base = detail::flat_tree<Key, std::pair<Key, T>, detail::first_key, Compare, Allocator, false, true>;
+	public:
+		using mapped_type = T;
+
+		using base::base;
+		using base::operator=;
+
+		friend void swap(flat_multimap &left, flat_multimap &right) noexcept(noexcept(left.swap(right))) {
+			left.swap(right);
+		}
+	};
+
+	template<class Key, class Value, class KeyOf, class Compare, class Alloc, bool Unique, bool Mutable, class Pred>
+	typename detail::flat_tree<Key, Value, KeyOf, Compare, Alloc, Unique, Mutable>::size_type erase_if(detail::flat_tree<Key, Value, KeyOf, Compare, Alloc, Unique, Mutable> &container, Pred pred) {
+		//Removing elements keeps the rest sorted
+		auto values = container.extract();
+		const auto erasedCount = erase_if(values, pred);
+		container.replace(std::move(values));
+		return erasedCount;
+	}
+}
+
+#endif //FLAT_MAP_HPP
@@ -0,0 +1,512 @@
+#ifndef INCREMENTAL_VECTOR_HPP
+#define INCREMENTAL_VECTOR_HPP 1
+
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//A vector whose growth is spread over later operations instead of moving everything at once
+	//When push_back runs out of room a bigger buffer is allocated, but the existing elements stay where
+	//	they are. Every following push_back/emplace_back/pop_back migrates a few of them, so no single call
+	//	moves more than max(MigrationStep, ceil(1 / (growth factor - 1))) old elements. Until migration
+	//	finishes, indexing checks which of the two buffers holds the element
+	//data(), and reserve()/shrink_to_fit() when they reallocate, need the elements to be contiguous and
+	//	finish the migration first
+	//Elements whose move can throw are copied, and a copy that throws would make push_back/pop_back fail
+	//	after they had done their work. Those elements aren't migrated step by step, they wait for
+	//	finish_migration(), which the next growth calls before anything changes
+	template<class Type, class Allocator = std::allocator<Type>, class GrowthPolicy = default_growth, std::size_t MigrationStep = 64>
+	class incremental_vector {
+	public:
+		using allocator_type 	= Allocator;
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= typename std::allocator_traits<Allocator>::pointer;
+		using const_pointer 	= typename std::allocator_traits<Allocator>::const_pointer;
+		using iterator 				= detail::indexed_iterator<incremental_vector, Type>;
+		using const_iterator 	= detail::indexed_iterator<const incremental_vector, const Type>;
+		using reverse_iterator 				= std::reverse_iterator<iterator>;
+		using const_reverse_iterator 	= std::reverse_iterator<const_iterator>;
+
+		static_assert(MigrationStep > 0, "incremental_vector must migrate at least one element per operation");
+
+	private:
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		allocator_type vectorAllocator;
+		pointer dataBegin{nullptr};
+		size_type dataSize{0};
+		size_type dataCapacity{0};
+		//While migrating, elements [migrateBegin, migrateEnd) are still in oldBegin at their own index
+		pointer oldBegin{nullptr};
+		size_type oldCapacity{0};
+		size_type migrateBegin{0};
+		size_type migrateEnd{0};
+		size_type migrationStep{MigrationStep};
+
+		bool isMigrating() const {
+			return oldBegin != nullptr;
+		}
+
+		pointer elementAddress(size_type index) const {
+			if (index >= migrateBegin && index < migrateEnd) {
+				return oldBegin + index;
+			}
+			return dataBegin + index;
+		}
+
+		size_type nextCapacity(size_type required) const {
+			return GrowthPolicy::next_capacity(dataCapacity, required, sizeof(value_type));
+		}
+
+		//Moves up to count elements from the old buffer to the new one
+		void migrate(size_type count) {
+			const size_type migrateStop = std::min(migrateEnd, migrateBegin + count);
+			if constexpr (is_trivially_relocatable_v<value_type>) {
+				detail::relocate(vectorAllocator, oldBegin + migrateBegin, oldBegin + migrateStop, dataBegin + migrateBegin);
+				migrateBegin = migrateStop;
+			} else {
+				//One at a time so that a throwing move leaves every element in exactly one place
+				for (; migrateBegin<migrateStop; ++migrateBegin) {
+					allocatorTraits::construct(vectorAllocator, dataBegin + migrateBegin, std::move_if_noexcept(oldBegin[migrateBegin]));
+					allocatorTraits::destroy(vectorAllocator, oldBegin + migrateBegin);
+				}
+			}
+			if (migrateBegin == migrateEnd) {
+				releaseOldBuffer();
+			}
+		}
+
+		void releaseOldBuffer() {
+			if (oldBegin != nullptr) {
+				allocatorTraits::deallocate(vectorAllocator, oldBegin, oldCapacity);
+			}
+			oldBegin = nullptr;
+			oldCapacity = 0;
+			migrateBegin = migrateEnd = 0;
+		}
+
+		static constexpr bool migrationCanThrow = !is_trivially_relocatable_v<value_type> && !std::is_nothrow_move_constructible<value_type>::value;
+
+		//Never throws, see the class comment
+		void migrateStep() noexcept {
+			if constexpr (!migrationCanThrow) {
+				if (isMigrating()) {
+					migrate(migrationStep);
+				}
+			}
+		}
+
+		//Switches to a new buffer, leaving the elements to be migrated later
+		void beginMigration(size_type newCapacity) {
+			if (newCapacity > max_size()) {
+				throw std::length_error("incremental_vector::reallocate() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			finish_migration();
+			pointer newDataBegin = allocatorTraits::allocate(vectorAllocator, newCapacity);
+			oldBegin = dataBegin;
+			oldCapacity = dataCapacity;
+			migrateBegin = 0;
+			migrateEnd = dataSize;
+			dataBegin = newDataBegin;
+			dataCapacity = newCapacity;
+			//Migration has to be done before the new buffer fills up
+			const size_type freeSlots = newCapacity - dataSize;
+			migrationStep = std::max<size_type>(MigrationStep, (dataSize + freeSlots - 1) / freeSlots);
+			if (dataSize == 0) {
+				releaseOldBuffer();
+			}
+		}
+
+		//Moves everything into a buffer of exactly newCapacity elements
+		void reallocate(size_type newCapacity) {
+			finish_migration();
+			if (newCapacity > max_size()) {
+				throw std::length_error("incremental_vector::reallocate() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			pointer newDataBegin = (newCapacity == 0 ? nullptr : allocatorTraits::allocate(vectorAllocator, newCapacity));
+			detail::relocate(vectorAllocator, dataBegin, dataBegin + dataSize, newDataBegin);
+			if (dataBegin != nullptr) {
+				allocatorTraits::deallocate(vectorAllocator, dataBegin, dataCapacity);
+			}
+			dataBegin = newDataBegin;
+			dataCapacity = newCapacity;
+		}
+
+		void destroyAll() {
+			if constexpr (!std::is_trivially_destructible<value_type>::value) {
+				for (size_type i=0; i<dataSize; ++i) {
+					allocatorTraits::destroy(vectorAllocator, elementAddress(i));
+				}
+			}
+			dataSize = 0;
+			releaseOldBuffer();
+		}
+
+		//Destroys every element and frees both buffers
+		void releaseStorage() {
+			destroyAll();
+			if (dataBegin != nullptr) {
+				allocatorTraits::deallocate(vectorAllocator, dataBegin, dataCapacity);
+			}
+			dataBegin = nullptr;
+			dataCapacity = 0;
+		}
+
+		//Constructors fill the vector through this, like vector::initialize, since the destructor won't run
+		//	to release the buffers if an element constructor throws
+		template<class Fill>
+		void initialize(Fill fill) {
+			try {
+				fill();
+			} catch (...) {
+				releaseStorage();
+				throw;
+			}
+		}
+
+		template<class InputIt>
+		void append(InputIt first, InputIt last) {
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				reserve(dataSize + std::distance(first, last));
+			}
+			for (; first != last; ++first) {
+				emplace_back(*first);
+			}
+		}
+
+		void stealStorage(incremental_vector &other) {
+			dataBegin = other.dataBegin;
+			dataSize = other.dataSize;
+			dataCapacity = other.dataCapacity;
+			oldBegin = other.oldBegin;
+			oldCapacity = other.oldCapacity;
+			migrateBegin = other.migrateBegin;
+			migrateEnd = other.migrateEnd;
+			migrationStep = other.migrationStep;
+			other.dataBegin = other.oldBegin = nullptr;
+			other.dataSize = other.dataCapacity = other.oldCapacity = other.migrateBegin = other.migrateEnd = 0;
+		}
+
+	public:
+		incremental_vector() : incremental_vector(Allocator()) {}
+
+		explicit incremental_vector(const Allocator &alloc) : vectorAllocator(alloc) {}
+
+		explicit incremental_vector(size_type count, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize([&]() {
+				resize(count);
+			});
+		}
+
+		incremental_vector(size_type count, const Type &value, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize([&]() {
+				resize(count, value);
+			});
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		incremental_vector(InputIt first, InputIt last, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize([&]() {
+				append(first, last);
+			});
+		}
+
+		incremental_vector(std::initializer_list<Type> ilist, const Allocator &alloc = Allocator()) : incremental_vector(ilist.begin(), ilist.end(), alloc) {}
+
+		incremental_vector(const incremental_vector &other) : incremental_vector(other.begin(), other.end(), allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+		incremental_vector(incremental_vector &&other) noexcept : vectorAllocator(std::move(other.vectorAllocator)) {
+			stealStorage(other);
+		}
+
+		~incremental_vector() {
+			releaseStorage();
+		}
+
+		//The copy is built with the allocator we end up with, so its buffers can be taken over
+		incremental_vector& operator=(const incremental_vector &other) {
+			if (&other != this) {
+				const bool propagate = allocatorTraits::propagate_on_container_copy_assignment::value;
+				incremental_vector copy(other.begin(), other.end(), (propagate ? other.vectorAllocator : vectorAllocator));
+				releaseStorage();
+				if (propagate) {
+					vectorAllocator = copy.vectorAllocator;
+				}
+				stealStorage(copy);
+			}
+			return *this;
+		}
+
+		incremental_vector& operator=(incremental_vector &&other) noexcept(allocatorTraits::propagate_on_container_move_assignment::value || allocatorTraits::is_always_equal::value) {
+			if (&other != this) {
+				if (typename allocatorTraits::propagate_on_container_move_assignment()) {
+					//Release our buffers with the allocator that allocated them
+					releaseStorage();
+					//Allocator is propigated
+					vectorAllocator = std::move(other.vectorAllocator);
+					stealStorage(other);
+				} else if (vectorAllocator != other.vectorAllocator) {
+					//Allocators are different and dont propigate
+					//keep our allocator and move-construct all elements
+					destroyAll();
+					append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+				} else {
+					//Allocators are equal
+					releaseStorage();
+					stealStorage(other);
+				}
+			}
+			return *this;
+		}
+
+		allocator_type get_allocator() const {
+			return vectorAllocator;
+		}
+
+		reference at(size_type pos) {
+			if (pos >= size()) {
+				throw std::out_of_range("incremental_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return *elementAddress(pos);
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= size()) {
+				throw std::out_of_range("incremental_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return *elementAddress(pos);
+		}
+
+		reference operator[](size_type pos) {
+			return *elementAddress(pos);
+		}
+
+		const_reference operator[](size_type pos) const {
+			return *elementAddress(pos);
+		}
+
+		reference front() {
+			return (*this)[0];
+		}
+
+		const_reference front() const {
+			return (*this)[0];
+		}
+
+		reference back() {
+			return (*this)[dataSize - 1];
+		}
+
+		const_reference back() const {
+			return (*this)[dataSize - 1];
+		}
+
+		//Finishes any migration in progress
+		pointer data() {
+			finish_migration();
+			return dataBegin;
+		}
+
+		iterator begin() {
+			return iterator(this, 0);
+		}
+
+		const_iterator begin() const {
+			return const_iterator(this, 0);
+		}
+
+		const_iterator cbegin() const {
+			return const_iterator(this, 0);
+		}
+
+		iterator end() {
+			return iterator(this, dataSize);
+		}
+
+		const_iterator end() const {
+			return const_iterator(this, dataSize);
+		}
+
+		const_iterator cend() const {
+			return const_iterator(this, dataSize);
+		}
+
+		reverse_iterator rbegin() {
+			return reverse_iterator(end());
+		}
+
+		const_reverse_iterator rbegin() const {
+			return const_reverse_iterator(end());
+		}
+
+		reverse_iterator rend() {
+			return reverse_iterator(begin());
+		}
+
+		const_reverse_iterator rend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		bool empty() const {
+			return dataSize == 0;
+		}
+
+		size_type size() const {
+			return dataSize;
+		}
+
+		size_type max_size() const {
+			return allocatorTraits::max_size(vectorAllocator);
+		}
+
+		size_type capacity() const {
+			return dataCapacity;
+		}
+
+		bool migrating() const {
+			return isMigrating();
+		}
+
+		//Moves every remaining element to the current buffer now
+		void finish_migration() {
+			if (isMigrating()) {
+				migrate(migrateEnd - migrateBegin);
+			}
+		}
+
+		void reserve(size_type newCapacity) {
+			if (dataCapacity < newCapacity) {
+				reallocate(newCapacity);
+			}
+		}
+
+		void shrink_to_fit() {
+			if (dataSize < dataCapacity) {
+				reallocate(dataSize);
+			}
+		}
+
+		void clear() {
+			destroyAll();
+		}
+
+		void push_back(const value_type &obj) {
+			emplace_back(obj);
+		}
+
+		void push_back(value_type &&obj) {
+			emplace_back(std::move(obj));
+		}
+
+		template<class... Args>
+		reference emplace_back(Args&&... args) {
+			if (dataSize == dataCapacity) {
+				//args may refer to an element, which stays in the old buffer until it is migrated
+				beginMigration(nextCapacity(dataSize + 1));
+			}
+			pointer element = dataBegin + dataSize;
+			allocatorTraits::construct(vectorAllocator, element, std::forward<Args>(args)...);
+			++dataSize;
+			migrateStep();
+			return *element;
+		}
+
+		void pop_back() {
+			--dataSize;
+			allocatorTraits::destroy(vectorAllocator, elementAddress(dataSize));
+			if (isMigrating() && dataSize < migrateEnd) {
+				//That was the last element still waiting to be migrated
+				migrateEnd = dataSize;
+			}
+			migrateStep();
+		}
+
+		void resize(size_type count) {
+			if (dataSize < count) {
+				reserve(count);
+				while (dataSize < count) {
+					emplace_back();
+				}
+			} else {
+				while (dataSize > count) {
+					pop_back();
+				}
+			}
+		}
+
+		void resize(size_type count, const value_type &value) {
+			if (dataSize < count) {
+				//reserve() would move value if it is one of our elements
+				const value_type copy(value);
+				reserve(count);
+				while (dataSize < count) {
+					emplace_back(copy);
+				}
+			} else {
+				while (dataSize > count) {
+					pop_back();
+				}
+			}
+		}
+
+		void swap(incremental_vector &other) noexcept(allocatorTraits::propagate_on_container_swap::value || allocatorTraits::is_always_equal::value) {
+			if (typename allocatorTraits::propagate_on_container_swap()) {
+				std::swap(vectorAllocator, other.vectorAllocator);
+			}
+			std::swap(dataBegin, other.dataBegin);
+			std::swap(dataSize, other.dataSize);
+			std::swap(dataCapacity, other.dataCapacity);
+			std::swap(oldBegin, other.oldBegin);
+			std::swap(oldCapacity, other.oldCapacity);
+			std::swap(migrateBegin, other.migrateBegin);
+			std::swap(migrateEnd, other.migrateEnd);
+			std::swap(migrationStep, other.migrationStep);
+		}
+	};
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	bool operator==(const incremental_vector<T, Alloc, Growth, Step> &left, const incremental_vector<T, Alloc, Growth, Step> &right) {
+		return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin());
+	}
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	bool operator!=(const incremental_vector<T, Alloc, Growth, Step> &left, const incremental_vector<T, Alloc, Growth, Step> &right) {
+		return !(left == right);
+	}
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	bool operator<(const incremental_vector<T, Alloc, Growth, Step> &left, const incremental_vector<T, Alloc, Growth, Step> &right) {
+		return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end());
+	}
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	bool operator<=(const incremental_vector<T, Alloc, Growth, Step> &left, const incremental_vector<T, Alloc, Growth, Step> &right) {
+		return !(right < left);
+	}
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	bool operator>(const incremental_vector<T, Alloc, Growth, Step> &left, const incremental_vector<T, Alloc, Growth, Step> &right) {
+		return right < left;
+	}
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	bool operator>=(const incremental_vector<T, Alloc, Growth, Step> &left, const incremental_vector<T, Alloc, Growth, Step> &right) {
+		return !(left < right);
+	}
+
+	template<class T, class Alloc, class Growth, std::size_t Step>
+	void swap(incremental_vector<T, Alloc, Growth, Step> &left, incremental_vector<T, Alloc, Growth, Step> &right) noexcept(noexcept(left.swap(right))) {
+		left.swap(right);
+	}
+}
+
+#endif //INCREMENTAL_VECTOR_HPP
@@ -0,0 +1,487 @@
+#ifndef MAPPED_VECTOR_HPP
+#define MAPPED_VECTOR_HPP 1
+
+#include "vector.hpp"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace sandsnip3r {
+
+	//The start of every mapped_vector file, the elements follow it
+	//	64 bytes so that elements up to cache line alignment need no padding
+	struct mapped_vector_header {
+		static constexpr std::uint64_t MAGIC = 0x3152504E53444E53; //"SNDSNPR1"
+		static constexpr std::uint32_t VERSION = 1;
+
+		std::uint64_t magic;
+		std::uint32_t version;
+		std::uint32_t elementSize;
+		std::uint64_t elementAlignment;
+		std::uint64_t size;
+		std::uint64_t capacity;
+		std::uint64_t reserved[3];
+	};
+
+	static_assert(sizeof(mapped_vector_header) == 64, "mapped_vector_header must stay 64 bytes");
+
+	template<class Type, class GrowthPolicy>
+	class mapped_vector_view;
+
+	//A vector whose elements live in a memory-mapped file, reopening the file gives back the same
+	//	elements without parsing or copying them. Changes are written straight to the file
+	//Use mapped_vector_view to open a file read-only
+	//Only trivially copyable types are allowed, since the bytes are stored exactly as they are in memory.
+	//	The file format depends on the size, alignment and byte order of Type
+	template<class Type, class GrowthPolicy = default_growth>
+	class mapped_vector {
+	public:
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= Type*;
+		using const_pointer 	= const Type*;
+		using iterator 				= pointer;
+		using const_iterator 	= const_pointer;
+		using reverse_iterator 				= std::reverse_iterator<iterator>;
+		using const_reverse_iterator 	= std::reverse_iterator<const_iterator>;
+
+		static_assert(std::is_trivially_copyable<Type>::value, "mapped_vector can only store trivially copyable types");
+		static_assert(alignof(Type) <= sizeof(mapped_vector_header), "mapped_vector elements can be aligned to at most 64 bytes");
+
+	private:
+		static constexpr std::size_t HEADER_BYTES = sizeof(mapped_vector_header);
+		int fileDescriptor{-1};
+		char *mapping{nullptr};
+		std::size_t mappingBytes{0};
+		bool readOnly{false};
+		std::string filePath;
+
+		static std::size_t bytesFor(size_type capacity) {
+			return HEADER_BYTES + capacity * sizeof(Type);
+		}
+
+		mapped_vector_header& header() {
+			return *reinterpret_cast<mapped_vector_header*>(mapping);
+		}
+
+		const mapped_vector_header& header() const {
+			return *reinterpret_cast<const mapped_vector_header*>(mapping);
+		}
+
+		pointer dataBegin() const {
+			return reinterpret_cast<pointer>(mapping + HEADER_BYTES);
+		}
+
+		[[noreturn]] void throwSystemError(const char *operation) const {
+			throw std::system_error(errno, std::generic_category(), "mapped_vector: "+std::string(operation)+" failed for "+filePath);
+		}
+
+		void validateHeader(std::size_t fileBytes) const {
+			const mapped_vector_header &fileHeader = header();
+			if (fileHeader.magic != mapped_vector_header::MAGIC || fileHeader.version != mapped_vector_header::VERSION) {
+				throw std::runtime_error("mapped_vector: "+filePath+" is not a mapped_vector file of version "+std::to_string(mapped_vector_header::VERSION));
+			}
+			if (fileHeader.elementSize != sizeof(Type)) {
+				throw std::runtime_error("mapped_vector: "+filePath+" holds elements of size "+std::to_string(fileHeader.elementSize)+" (expected "+std::to_string(sizeof(Type))+")");
+			}
+			if (fileHeader.elementAlignment != alignof(Type)) {
+				throw std::runtime_error("mapped_vector: "+filePath+" holds elements of alignment "+std::to_string(fileHeader.elementAlignment)+" (expected "+std::to_string(alignof(Type))+")");
+			}
+			if (fileHeader.size > fileHeader.capacity || fileHeader.capacity > (fileBytes - HEADER_BYTES) / sizeof(Type)) {
+				throw std::runtime_error("mapped_vector: "+filePath+" is truncated");
+			}
+		}
+
+		void open() {
+			fileDescriptor = ::open(filePath.c_str(), (readOnly ? O_RDONLY : O_RDWR | O_CREAT) | O_CLOEXEC, 0644);
+			if (fileDescriptor < 0) {
+				throwSystemError("open()");
+			}
+			struct stat fileStat;
+			if (::fstat(fileDescriptor, &fileStat) != 0) {
+				throwSystemError("fstat()");
+			}
+			std::size_t fileBytes = fileStat.st_size;
+			const bool isNewFile = (fileBytes == 0 && !readOnly);
+			if (isNewFile) {
+				fileBytes = HEADER_BYTES;
+				if (::ftruncate(fileDescriptor, fileBytes) != 0) {
+					throwSystemError("ftruncate()");
+				}
+			} else if (fileBytes < HEADER_BYTES) {
+				throw std::runtime_error("mapped_vector: "+filePath+" is too small to be a mapped_vector file");
+			}
+			void *address = ::mmap(nullptr, fileBytes, (readOnly ? PROT_READ : PROT_READ | PROT_WRITE), MAP_SHARED, fileDescriptor, 0);
+			if (address == MAP_FAILED) {
+				throwSystemError("mmap()");
+			}
+			mapping = static_cast<char*>(address);
+			mappingBytes = fileBytes;
+			if (isNewFile) {
+				header() = mapped_vector_header{mapped_vector_header::MAGIC, mapped_vector_header::VERSION, sizeof(Type), alignof(Type), 0, 0, {}};
+			} else {
+				validateHeader(fileBytes);
+			}
+		}
+
+		void close() {
+			if (mapping != nullptr) {
+				::munmap(mapping, mappingBytes);
+				mapping = nullptr;
+				mappingBytes = 0;
+			}
+			if (fileDescriptor >= 0) {
+				::close(fileDescriptor);
+				fileDescriptor = -1;
+			}
+		}
+
+		void remap(std::size_t newBytes) {
+			void *address = ::mremap(mapping, mappingBytes, newBytes, MREMAP_MAYMOVE);
+			if (address == MAP_FAILED) {
+				throwSystemError("mremap()");
+			}
+			mapping = static_cast<char*>(address);
+			mappingBytes = newBytes;
+		}
+
+		void reallocate(size_type newCapacity) {
+			if (newCapacity > max_size()) {
+				throw std::length_error("mapped_vector::reallocate() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			//The file is resized first, the pages past its end are never touched before the mapping catches up.
+			//	If remapping fails the file gets its old length back, so capacity still describes both
+			const std::size_t oldBytes = mappingBytes;
+			const std::size_t newBytes = bytesFor(newCapacity);
+			if (::ftruncate(fileDescriptor, newBytes) != 0) {
+				throwSystemError("ftruncate()");
+			}
+			try {
+				remap(newBytes);
+			} catch (...) {
+				if (::ftruncate(fileDescriptor, oldBytes) != 0) {
+					//The remap failure is the error worth reporting
+				}
+				throw;
+			}
+			header().capacity = newCapacity;
+		}
+
+		void reallocateToNewSizeIfNecessary(size_type newCapacity) {
+			if (capacity() < newCapacity) {
+				reallocate(newCapacity);
+			}
+		}
+
+		friend class mapped_vector_view<Type, GrowthPolicy>;
+
+		struct read_only_t {};
+
+		//Maps an existing file PROT_READ, only mapped_vector_view hands this out and only as const
+		mapped_vector(std::string path, read_only_t) : readOnly(true), filePath(std::move(path)) {
+			try {
+				open();
+			} catch (...) {
+				close();
+				throw;
+			}
+		}
+
+	public:
+		//Opens the file, creating it if it doesn't exist
+		explicit mapped_vector(std::string path) : filePath(std::move(path)) {
+			try {
+				open();
+			} catch (...) {
+				close();
+				throw;
+			}
+		}
+
+		mapped_vector(const mapped_vector &other) = delete;
+
+		mapped_vector(mapped_vector &&other) noexcept : fileDescriptor(other.fileDescriptor), mapping(other.mapping), mappingBytes(other.mappingBytes), readOnly(other.readOnly), filePath(std::move(other.filePath)) {
+			other.fileDescriptor = -1;
+			other.mapping = nullptr;
+			other.mappingBytes = 0;
+		}
+
+		~mapped_vector() {
+			close();
+		}
+
+		mapped_vector& operator=(const mapped_vector &other) = delete;
+
+		mapped_vector& operator=(mapped_vector &&other) noexcept {
+			if (&other != this) {
+				close();
+				std::swap(fileDescriptor, other.fileDescriptor);
+				std::swap(mapping, other.mapping);
+				std::swap(mappingBytes, other.mappingBytes);
+				readOnly = other.readOnly;
+				filePath = std::move(other.filePath);
+			}
+			return *this;
+		}
+
+		const std::string& path() const {
+			return filePath;
+		}
+
+		reference at(size_type pos) {
+			if (pos >= size()) {
+				throw std::out_of_range("mapped_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return dataBegin()[pos];
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= size()) {
+				throw std::out_of_range("mapped_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return dataBegin()[pos];
+		}
+
+		reference operator[](size_type pos) {
+			return dataBegin()[pos];
+		}
+
+		const_reference operator[](size_type pos) const {
+			return dataBegin()[pos];
+		}
+
+		reference front() {
+			return *begin();
+		}
+
+		const_reference front() const {
+			return *begin();
+		}
+
+		reference back() {
+			return *(end() - 1);
+		}
+
+		const_reference back() const {
+			return *(end() - 1);
+		}
+
+		pointer data() {
+			return dataBegin();
+		}
+
+		const_pointer data() const {
+			return dataBegin();
+		}
+
+		iterator begin() {
+			return dataBegin();
+		}
+
+		const_iterator begin() const {
+			return dataBegin();
+		}
+
+		const_iterator cbegin() const {
+			return dataBegin();
+		}
+
+		iterator end() {
+			return dataBegin() + size();
+		}
+
+		const_iterator end() const {
+			return dataBegin() + size();
+		}
+
+		const_iterator cend() const {
+			return dataBegin() + size();
+		}
+
+		reverse_iterator rbegin() {
+			return reverse_iterator(end());
+		}
+
+		const_reverse_iterator rbegin() const {
+			return const_reverse_iterator(end());
+		}
+
+		reverse_iterator rend() {
+			return reverse_iterator(begin());
+		}
+
+		const_reverse_iterator rend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		bool empty() const {
+			return size() == 0;
+		}
+
+		//A moved-from vector has no mapping and is empty
+		size_type size() const {
+			return (mapping == nullptr ? 0 : header().size);
+		}
+
+		size_type max_size() const {
+			return (std::numeric_limits<off_t>::max() - HEADER_BYTES) / sizeof(Type);
+		}
+
+		void reserve(size_type newCapacity) {
+			reallocateToNewSizeIfNecessary(newCapacity);
+		}
+
+		size_type capacity() const {
+			return (mapping == nullptr ? 0 : header().capacity);
+		}
+
+		//Also shrinks the file
+		void shrink_to_fit() {
+			if (size() < capacity()) {
+				reallocate(size());
+			}
+		}
+
+		void clear() {
+			header().size = 0;
+		}
+
+		void push_back(const value_type &obj) {
+			emplace_back(obj);
+		}
+
+		template<class... Args>
+		reference emplace_back(Args&&... args) {
+			//Construct first, args may refer to an element which moves when the mapping grows
+			value_type value(std::forward<Args>(args)...);
+			const size_type oldSize = size();
+			if (oldSize == capacity()) {
+				reallocate(GrowthPolicy::next_capacity(capacity(), oldSize + 1, sizeof(value_type)));
+			}
+			std::memcpy(static_cast<void*>(dataBegin() + oldSize), static_cast<const void*>(&value), sizeof(value_type));
+			header().size = oldSize + 1;
+			return dataBegin()[oldSize];
+		}
+
+		void pop_back() {
+			--header().size;
+		}
+
+		//New elements are value-initialized
+		void resize(size_type count) {
+			resize(count, value_type());
+		}
+
+		void resize(size_type count, const value_type &value) {
+			if (size() < count) {
+				const value_type copy(value);
+				reallocateToNewSizeIfNecessary(count);
+				std::uninitialized_fill(end(), dataBegin() + count, copy);
+			}
+			header().size = count;
+		}
+
+		//Write the mapped pages back to the file
+		void sync() {
+			if (::msync(mapping, mappingBytes, MS_SYNC) != 0) {
+				throwSystemError("msync()");
+			}
+		}
+	};
+
+	//A read-only mapped_vector, the pages are mapped PROT_READ and can be shared between processes
+	//	Only const access is offered, so nothing can write to them
+	template<class Type, class GrowthPolicy = default_growth>
+	class mapped_vector_view {
+	private:
+		using vector_type = mapped_vector<Type, GrowthPolicy>;
+		vector_type mappedVector;
+
+	public:
+		using value_type 			= typename vector_type::value_type;
+		using size_type 			= typename vector_type::size_type;
+		using difference_type = typename vector_type::difference_type;
+		using reference 			= typename vector_type::const_reference;
+		using const_reference = typename vector_type::const_reference;
+		using pointer 				= typename vector_type::const_pointer;
+		using const_pointer 	= typename vector_type::const_pointer;
+		using iterator 				= typename vector_type::const_iterator;
+		using const_iterator 	= typename vector_type::const_iterator;
+		using reverse_iterator 				= typename vector_type::const_reverse_iterator;
+		using const_reverse_iterator 	= typename vector_type::const_reverse_iterator;
+
+		//The file must already exist
+		explicit mapped_vector_view(std::string path) : mappedVector(std::move(path), typename vector_type::read_only_t{}) {}
+
+		const std::string& path() const {
+			return mappedVector.path();
+		}
+
+		const_reference at(size_type pos) const {
+			return mappedVector.at(pos);
+		}
+
+		const_reference operator[](size_type pos) const {
+			return mappedVector[pos];
+		}
+
+		const_reference front() const {
+			return mappedVector.front();
+		}
+
+		const_reference back() const {
+			return mappedVector.back();
+		}
+
+		const_pointer data() const {
+			return mappedVector.data();
+		}
+
+		const_iterator begin() const {
+			return mappedVector.begin();
+		}
+
+		const_iterator cbegin() const {
+			return mappedVector.cbegin();
+		}
+
+		const_iterator end() const {
+			return mappedVector.end();
+		}
+
+		const_iterator cend() const {
+			return mappedVector.cend();
+		}
+
+		const_reverse_iterator rbegin() const {
+			return mappedVector.rbegin();
+		}
+
+		const_reverse_iterator rend() const {
+			return mappedVector.rend();
+		}
+
+		bool empty() const {
+			return mappedVector.empty();
+		}
+
+		size_type size() const {
+			return mappedVector.size();
+		}
+
+		size_type capacity() const {
+			return mappedVector.capacity();
+		}
+	};
+}
+
+#endif //__linux__
+
+#endif //MAPPED_VECTOR_HPP
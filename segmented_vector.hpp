@@ -0,0 +1,503 @@
+#ifndef SEGMENTED_VECTOR_HPP
+#define SEGMENTED_VECTOR_HPP 1
+
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//A vector whose elements are kept in blocks that double in size, found through a small directory
+	//Growing allocates one more block and never moves an element, so there are no relocation spikes and
+	//	pointers and references stay valid across push_back, emplace_back, reserve and resize.
+	//	Inserting or erasing anywhere but the end shifts the values after that position from slot to
+	//	slot, as std::vector does, so a reference into that part then refers to a different value.
+	//	Indexing is O(1): a bit scan picks the block. The trade-off is that the elements aren't
+	//	contiguous, so there is no data()
+	template<class Type, class Allocator = std::allocator<Type>, std::size_t FirstSegmentSize = 8>
+	class segmented_vector {
+	public:
+		using allocator_type 	= Allocator;
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= typename std::allocator_traits<Allocator>::pointer;
+		using const_pointer 	= typename std::allocator_traits<Allocator>::const_pointer;
+		using iterator 				= detail::indexed_iterator<segmented_vector, Type>;
+		using const_iterator 	= detail::indexed_iterator<const segmented_vector, const Type>;
+		using reverse_iterator 				= std::reverse_iterator<iterator>;
+		using const_reverse_iterator 	= std::reverse_iterator<const_iterator>;
+
+	private:
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		using segments = detail::geometric_segments<FirstSegmentSize>;
+		allocator_type vectorAllocator;
+		pointer segmentTable[segments::SEGMENT_COUNT] = {};
+		//Segments [0, segmentCount) are allocated
+		size_type segmentCount{0};
+		size_type dataSize{0};
+
+		pointer elementAddress(size_type index) const {
+			const size_type segment = segments::segmentOf(index);
+			return segmentTable[segment] + segments::offsetInSegment(index, segment);
+		}
+
+		void reallocateToNewSizeIfNecessary(size_type newCapacity) {
+			if (newCapacity > max_size()) {
+				throw std::length_error("segmented_vector::reserve() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			while (capacity() < newCapacity) {
+				segmentTable[segmentCount] = allocatorTraits::allocate(vectorAllocator, segments::segmentSize(segmentCount));
+				++segmentCount;
+			}
+		}
+
+		//Frees segments holding no elements
+		void releaseSegmentsAbove(size_type count) {
+			while (segmentCount > 0 && segments::segmentBegin(segmentCount - 1) >= count) {
+				--segmentCount;
+				allocatorTraits::deallocate(vectorAllocator, segmentTable[segmentCount], segments::segmentSize(segmentCount));
+				segmentTable[segmentCount] = nullptr;
+			}
+		}
+
+		void resizeDown(size_type count) {
+			if constexpr (!std::is_trivially_destructible<value_type>::value) {
+				while (dataSize > count) {
+					--dataSize;
+					allocatorTraits::destroy(vectorAllocator, elementAddress(dataSize));
+				}
+			}
+			dataSize = count;
+		}
+
+		void stealStorage(segmented_vector &other) {
+			std::copy(other.segmentTable, other.segmentTable + other.segmentCount, segmentTable);
+			std::fill(other.segmentTable, other.segmentTable + other.segmentCount, nullptr);
+			segmentCount = other.segmentCount;
+			dataSize = other.dataSize;
+			other.segmentCount = 0;
+			other.dataSize = 0;
+		}
+
+		template<class InputIt>
+		void append(InputIt first, InputIt last) {
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				reserve(dataSize + std::distance(first, last));
+			}
+			for (; first != last; ++first) {
+				emplace_back(*first);
+			}
+		}
+
+		//Constructors fill the vector through this, like vector::initialize, releasing every segment if an
+		//	element constructor throws
+		template<class Fill>
+		void initialize(Fill fill) {
+			try {
+				fill();
+			} catch (...) {
+				resizeDown(0);
+				releaseSegmentsAbove(0);
+				throw;
+			}
+		}
+
+		//Moves the elements appended after oldSize to index
+		iterator rotateIntoPlace(size_type index, size_type oldSize) {
+			std::rotate(begin() + index, begin() + oldSize, end());
+			return begin() + index;
+		}
+
+	public:
+		segmented_vector() : segmented_vector(Allocator()) {}
+
+		explicit segmented_vector(const Allocator &alloc) : vectorAllocator(alloc) {}
+
+		explicit segmented_vector(size_type count, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize([&]() {
+				resize(count);
+			});
+		}
+
+		segmented_vector(size_type count, const Type &value, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize([&]() {
+				resize(count, value);
+			});
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		segmented_vector(InputIt first, InputIt last, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize([&]() {
+				append(first, last);
+			});
+		}
+
+		segmented_vector(std::initializer_list<Type> ilist, const Allocator &alloc = Allocator()) : segmented_vector(ilist.begin(), ilist.end(), alloc) {}
+
+		segmented_vector(const segmented_vector &other) : segmented_vector(other, allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+		segmented_vector(const segmented_vector &other, const Allocator &alloc) : vectorAllocator(alloc) {
+			initialize([&]() {
+				append(other.begin(), other.end());
+			});
+		}
+
+		segmented_vector(segmented_vector &&other) noexcept : vectorAllocator(std::move(other.vectorAllocator)) {
+			stealStorage(other);
+		}
+
+		segmented_vector(segmented_vector &&other, const Allocator &alloc) : vectorAllocator(alloc) {
+			if (alloc == other.vectorAllocator) {
+				stealStorage(other);
+			} else {
+				initialize([&]() {
+					append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+				});
+			}
+		}
+
+		~segmented_vector() {
+			resizeDown(0);
+			releaseSegmentsAbove(0);
+		}
+
+		segmented_vector& operator=(const segmented_vector &other) {
+			if (&other != this) {
+				if (typename allocatorTraits::propagate_on_container_copy_assignment() && vectorAllocator != other.vectorAllocator) {
+					//Our segments belong to the allocator we are about to replace
+					resizeDown(0);
+					releaseSegmentsAbove(0);
+				}
+				if (typename allocatorTraits::propagate_on_container_copy_assignment()) {
+					vectorAllocator = other.vectorAllocator;
+				}
+				//Assign over the elements we already have
+				const size_type common = std::min(dataSize, other.dataSize);
+				std::copy(other.begin(), other.begin() + common, begin());
+				resizeDown(common);
+				append(other.begin() + common, other.end());
+			}
+			return *this;
+		}
+
+		segmented_vector& operator=(segmented_vector &&other) noexcept(allocatorTraits::propagate_on_container_move_assignment::value || allocatorTraits::is_always_equal::value) {
+			if (&other != this) {
+				if (typename allocatorTraits::propagate_on_container_move_assignment() || vectorAllocator == other.vectorAllocator) {
+					resizeDown(0);
+					releaseSegmentsAbove(0);
+					if (typename allocatorTraits::propagate_on_container_move_assignment()) {
+						vectorAllocator = std::move(other.vectorAllocator);
+					}
+					stealStorage(other);
+				} else {
+					//Allocators are different and dont propigate
+					resizeDown(0);
+					append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+				}
+			}
+			return *this;
+		}
+
+		segmented_vector& operator=(std::initializer_list<value_type> ilist) {
+			resizeDown(0);
+			append(ilist.begin(), ilist.end());
+			return *this;
+		}
+
+		allocator_type get_allocator() const {
+			return vectorAllocator;
+		}
+
+		reference at(size_type pos) {
+			if (pos >= size()) {
+				throw std::out_of_range("segmented_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return *elementAddress(pos);
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= size()) {
+				throw std::out_of_range("segmented_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return *elementAddress(pos);
+		}
+
+		reference operator[](size_type pos) {
+			return *elementAddress(pos);
+		}
+
+		const_reference operator[](size_type pos) const {
+			return *elementAddress(pos);
+		}
+
+		reference front() {
+			return (*this)[0];
+		}
+
+		const_reference front() const {
+			return (*this)[0];
+		}
+
+		reference back() {
+			return (*this)[dataSize - 1];
+		}
+
+		const_reference back() const {
+			return (*this)[dataSize - 1];
+		}
+
+		iterator begin() {
+			return iterator(this, 0);
+		}
+
+		const_iterator begin() const {
+			return const_iterator(this, 0);
+		}
+
+		const_iterator cbegin() const {
+			return const_iterator(this, 0);
+		}
+
+		iterator end() {
+			return iterator(this, dataSize);
+		}
+
+		const_iterator end() const {
+			return const_iterator(this, dataSize);
+		}
+
+		const_iterator cend() const {
+			return const_iterator(this, dataSize);
+		}
+
+		reverse_iterator rbegin() {
+			return reverse_iterator(end());
+		}
+
+		const_reverse_iterator rbegin() const {
+			return const_reverse_iterator(end());
+		}
+
+		const_reverse_iterator crbegin() const {
+			return const_reverse_iterator(end());
+		}
+
+		reverse_iterator rend() {
+			return reverse_iterator(begin());
+		}
+
+		const_reverse_iterator rend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		const_reverse_iterator crend() const {
+			return const_reverse_iterator(begin());
+		}
+
+		bool empty() const {
+			return dataSize == 0;
+		}
+
+		size_type size() const {
+			return dataSize;
+		}
+
+		size_type max_size() const {
+			return std::min<size_type>(allocatorTraits::max_size(vectorAllocator), std::numeric_limits<size_type>::max() - FirstSegmentSize);
+		}
+
+		void reserve(size_type newCapacity) {
+			reallocateToNewSizeIfNecessary(newCapacity);
+		}
+
+		size_type capacity() const {
+			return segments::segmentBegin(segmentCount);
+		}
+
+		//Frees the blocks past the last element, nothing is moved
+		void shrink_to_fit() {
+			releaseSegmentsAbove(dataSize);
+		}
+
+		void clear() {
+			resizeDown(0);
+		}
+
+		iterator insert(const_iterator pos, const value_type &value) {
+			return emplace(pos, value);
+		}
+
+		iterator insert(const_iterator pos, value_type &&value) {
+			return emplace(pos, std::move(value));
+		}
+
+		iterator insert(const_iterator pos, size_type count, const value_type &value) {
+			const size_type index = pos - cbegin();
+			const size_type oldSize = dataSize;
+			//Elements never move while appending, so value stays valid even if it is one of ours
+			resize(dataSize + count, value);
+			return rotateIntoPlace(index, oldSize);
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		iterator insert(const_iterator pos, InputIt first, InputIt last) {
+			const size_type index = pos - cbegin();
+			const size_type oldSize = dataSize;
+			append(first, last);
+			return rotateIntoPlace(index, oldSize);
+		}
+
+		iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+			return insert(pos, ilist.begin(), ilist.end());
+		}
+
+		template<class... Args>
+		iterator emplace(const_iterator pos, Args&&... args) {
+			const size_type index = pos - cbegin();
+			const size_type oldSize = dataSize;
+			emplace_back(std::forward<Args>(args)...);
+			return rotateIntoPlace(index, oldSize);
+		}
+
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			const size_type firstIndex = first - cbegin();
+			const size_type lastIndex = last - cbegin();
+			if (firstIndex != lastIndex) {
+				std::move(begin() + lastIndex, end(), begin() + firstIndex);
+				resizeDown(dataSize - (lastIndex - firstIndex));
+			}
+			return begin() + firstIndex;
+		}
+
+		iterator erase_unordered(const_iterator pos) {
+			const size_type index = pos - cbegin();
+			if (index != dataSize - 1) {
+				(*this)[index] = std::move(back());
+			}
+			pop_back();
+			return begin() + index;
+		}
+
+		void push_back(const value_type &obj) {
+			emplace_back(obj);
+		}
+
+		void push_back(value_type &&obj) {
+			emplace_back(std::move(obj));
+		}
+
+		template<class... Args>
+		reference emplace_back(Args&&... args) {
+			reallocateToNewSizeIfNecessary(dataSize + 1);
+			pointer element = elementAddress(dataSize);
+			allocatorTraits::construct(vectorAllocator, element, std::forward<Args>(args)...);
+			++dataSize;
+			return *element;
+		}
+
+		void pop_back() {
+			--dataSize;
+			allocatorTraits::destroy(vectorAllocator, elementAddress(dataSize));
+		}
+
+		void resize(size_type count) {
+			if (dataSize < count) {
+				reallocateToNewSizeIfNecessary(count);
+				while (dataSize < count) {
+					emplace_back();
+				}
+			} else {
+				resizeDown(count);
+			}
+		}
+
+		void resize(size_type count, const value_type &value) {
+			if (dataSize < count) {
+				reallocateToNewSizeIfNecessary(count);
+				while (dataSize < count) {
+					emplace_back(value);
+				}
+			} else {
+				resizeDown(count);
+			}
+		}
+
+		void swap(segmented_vector &other) noexcept(allocatorTraits::propagate_on_container_swap::value || allocatorTraits::is_always_equal::value) {
+			if (typename allocatorTraits::propagate_on_container_swap()) {
+				std::swap(vectorAllocator, other.vectorAllocator);
+			}
+			std::swap(segmentTable, other.segmentTable);
+			std::swap(segmentCount, other.segmentCount);
+			std::swap(dataSize, other.dataSize);
+		}
+	};
+
+	template<class T, class Alloc, std::size_t N>
+	bool operator==(const segmented_vector<T, Alloc, N> &left, const segmented_vector<T, Alloc, N> &right) {
+		return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin());
+	}
+
+	template<class T, class Alloc, std::size_t N>
+	bool operator!=(const segmented_vector<T, Alloc, N> &left, const segmented_vector<T, Alloc, N> &right) {
+		return !(left == right);
+	}
+
+	template<class T, class Alloc, std::size_t N>
+	bool operator<(const segmented_vector<T, Alloc, N> &left, const segmented_vector<T, Alloc, N> &right) {
+		return std::lexicographical_compare(left.begin(), left.end(), right.begin(), right.end());
+	}
+
+	template<class T, class Alloc, std::size_t N>
+	bool operator<=(const segmented_vector<T, Alloc, N> &left, const segmented_vector<T, Alloc, N> &right) {
+		return !(right < left);
+	}
+
+	template<class T, class Alloc, std::size_t N>
+	bool operator>(const segmented_vector<T, Alloc, N> &left, const segmented_vector<T, Alloc, N> &right) {
+		return right < left;
+	}
+
+	template<class T, class Alloc, std::size_t N>
+	bool operator>=(const segmented_vector<T, Alloc, N> &left, const segmented_vector<T, Alloc, N> &right) {
+		return !(left < right);
+	}
+
+	template<class T, class Alloc, std::size_t N>
+	void swap(segmented_vector<T, Alloc, N> &left, segmented_vector<T, Alloc, N> &right) noexcept(noexcept(left.swap(right))) {
+		left.swap(right);
+	}
+
+	template<class T, class Alloc, std::size_t N, class Pred>
+	typename segmented_vector<T, Alloc, N>::size_type erase_if(segmented_vector<T, Alloc, N> &v, Pred pred) {
+		auto newEnd = std::remove_if(v.begin(), v.end(), pred);
+		const typename segmented_vector<T, Alloc, N>::size_type erasedCount = v.end() - newEnd;
+		v.erase(newEnd, v.end());
+		return erasedCount;
+	}
+
+	template<class T, class Alloc, std::size_t N, class U>
+	typename segmented_vector<T, Alloc, N>::size_type erase(segmented_vector<T, Alloc, N> &v, const U &value) {
+		return erase_if(v, [&value](const T &element) {
+			return element == value;
+		});
+	}
+}
+
+#endif //SEGMENTED_VECTOR_HPP
@@ -0,0 +1,202 @@
+#ifndef SMALL_VECTOR_HPP
+#define SMALL_VECTOR_HPP 1
+
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//A vector which keeps up to N elements inside the object itself and only moves to the heap
+	//	once it grows beyond that
+	//Everything except moving is inherited from a sandsnip3r::vector whose storage policy puts the inline
+	//	buffer in the object. The inheritance is private so a small_vector is never handed to code that
+	//	expects a plain vector
+	template<class Type, std::size_t N, class Allocator = std::allocator<Type>, class GrowthPolicy = default_growth>
+	class small_vector : private vector<Type, Allocator, GrowthPolicy, detail::inline_storage<Type, N>> {
+	private:
+		using base = vector<Type, Allocator, GrowthPolicy, detail::inline_storage<Type, N>>;
+		using allocatorTraits = std::allocator_traits<Allocator>;
+
+	public:
+		using typename base::allocator_type;
+		using typename base::value_type;
+		using typename base::size_type;
+		using typename base::difference_type;
+		using typename base::reference;
+		using typename base::const_reference;
+		using typename base::pointer;
+		using typename base::const_pointer;
+		using typename base::iterator;
+		using typename base::const_iterator;
+		using typename base::reverse_iterator;
+		using typename base::const_reverse_iterator;
+
+		using base::assign;
+		using base::get_allocator;
+		using base::at;
+		using base::operator[];
+		using base::front;
+		using base::back;
+		using base::data;
+		using base::begin;
+		using base::cbegin;
+		using base::end;
+		using base::cend;
+		using base::rbegin;
+		using base::crbegin;
+		using base::rend;
+		using base::crend;
+		using base::empty;
+		using base::size;
+		using base::max_size;
+		using base::reserve;
+		using base::capacity;
+		using base::clear;
+#ifdef SANDSNIP3R_VECTOR_STATS
+		using base::stats;
+#endif
+		using base::insert;
+		using base::emplace;
+		using base::erase;
+		using base::erase_unordered;
+		using base::push_back;
+		using base::emplace_back;
+		using base::push_back_unchecked;
+		using base::emplace_back_unchecked;
+		using base::append_n;
+		using base::append_range;
+		using base::pop_back;
+		using base::resize;
+		using base::resize_for_overwrite;
+		using base::resize_and_overwrite;
+
+		static_assert(N > 0, "small_vector needs room for at least one inline element");
+
+		small_vector() : small_vector(Allocator()) {}
+
+		explicit small_vector(const Allocator &alloc) : base(alloc) {
+			this->resetStorage();
+		}
+
+		explicit small_vector(size_type count, const Allocator &alloc = Allocator()) : small_vector(alloc) {
+			this->resize(count);
+		}
+
+		small_vector(size_type count, const Type &value, const Allocator &alloc = Allocator()) : small_vector(alloc) {
+			this->resize(count, value);
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		small_vector(InputIt first, InputIt last, const Allocator &alloc = Allocator()) : small_vector(alloc) {
+			this->assign(first, last);
+		}
+
+		small_vector(std::initializer_list<Type> ilist, const Allocator &alloc = Allocator()) : small_vector(ilist.begin(), ilist.end(), alloc) {}
+
+		small_vector(const small_vector &other) : small_vector(other.begin(), other.end(), allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+		//Inline elements are moved into our own inline storage, which never allocates
+		small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible<Type>::value) : small_vector(other.get_allocator()) {
+			if (other.usesInlineStorage()) {
+				this->moveElementsFrom(other);
+			} else {
+				//Our inline storage was never used, take the heap buffer over
+				this->stealStorage(other);
+			}
+		}
+
+		small_vector& operator=(const small_vector &other) {
+			base::operator=(other);
+			return *this;
+		}
+
+		//A heap buffer always has room for another small_vector's inline elements, so this only moves them
+		small_vector& operator=(small_vector &&other) noexcept(std::is_nothrow_move_constructible<Type>::value && (allocatorTraits::propagate_on_container_move_assignment::value || allocatorTraits::is_always_equal::value)) {
+			if (&other != this) {
+				this->moveAssign(other);
+			}
+			return *this;
+		}
+
+		small_vector& operator=(std::initializer_list<value_type> ilist) {
+			base::operator=(ilist);
+			return *this;
+		}
+
+		//Not noexcept, swapping inline elements goes through a temporary vector
+		void swap(small_vector &other) {
+			this->swapStorage(other);
+		}
+
+		static constexpr size_type inline_capacity() {
+			return N;
+		}
+
+		//Like vector::shrink_to_fit, but moves the elements back inline when they fit
+		void shrink_to_fit() {
+			if (this->usesInlineStorage()) {
+				this->recordWaste();
+				return;
+			}
+			const auto dataSize = this->size();
+			if (dataSize > N) {
+				base::shrink_to_fit();
+				return;
+			}
+			pointer inlineBegin = this->inlineData();
+			pointer inlineEnd = detail::relocate(this->vectorAllocator, this->dataBegin, this->dataEnd, inlineBegin);
+			this->deallocate(this->dataBegin, this->capacity());
+			this->dataBegin = inlineBegin;
+			this->dataEnd = inlineEnd;
+			this->containerEnd = inlineBegin + N;
+			this->recordReallocation(dataSize);
+			this->recordWaste();
+		}
+
+		friend bool operator==(const small_vector &left, const small_vector &right) {
+			return static_cast<const base&>(left) == static_cast<const base&>(right);
+		}
+
+		friend bool operator!=(const small_vector &left, const small_vector &right) {
+			return static_cast<const base&>(left) != static_cast<const base&>(right);
+		}
+
+		friend bool operator<(const small_vector &left, const small_vector &right) {
+			return static_cast<const base&>(left) < static_cast<const base&>(right);
+		}
+
+		friend bool operator<=(const small_vector &left, const small_vector &right) {
+			return static_cast<const base&>(left) <= static_cast<const base&>(right);
+		}
+
+		friend bool operator>(const small_vector &left, const small_vector &right) {
+			return static_cast<const base&>(left) > static_cast<const base&>(right);
+		}
+
+		friend bool operator>=(const small_vector &left, const small_vector &right) {
+			return static_cast<const base&>(left) >= static_cast<const base&>(right);
+		}
+
+		template<class Pred>
+		friend size_type erase_if(small_vector &v, Pred pred) {
+			return sandsnip3r::erase_if(static_cast<base&>(v), pred);
+		}
+
+		template<class U>
+		friend size_type erase(small_vector &v, const U &value) {
+			return sandsnip3r::erase(static_cast<base&>(v), value);
+		}
+	};
+
+	template<class T, std::size_t N, class Alloc, class Growth>
+	void swap(small_vector<T, N, Alloc, Growth> &left, small_vector<T, N, Alloc, Growth> &right) {
+		left.swap(right);
+	}
+}
+
+#endif //SMALL_VECTOR_HPP
@@ -0,0 +1,342 @@
+#ifndef SNAPSHOT_VECTOR_HPP
+#define SNAPSHOT_VECTOR_HPP 1
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//A read-mostly vector with one writer and any number of readers that never block
+	//Readers call take_snapshot() to get an immutable view (elements plus size) which stays valid for as
+	//	long as they hold it, no matter what the writer does in the meantime
+	//The writer appends in place while the buffer has room, since readers never look past the size they
+	//	saw. Anything else (replacing or removing elements, growing) copies into a new buffer which is
+	//	published with a single atomic store. Old buffers are retired and reclaimed with epochs: a reader
+	//	pins the current epoch in one of ReaderSlots slots for the lifetime of its snapshot, and a buffer
+	//	retired in epoch R is freed once no slot holds an epoch older than R
+	//take_snapshot() is lock-free as long as no more than ReaderSlots snapshots are held at once, a reader
+	//	can lose the race for a slot to another reader but some reader always wins it. With every slot taken
+	//	it waits for one. All other members belong to the writer and must not be called concurrently
+	template<class Type, class Allocator = std::allocator<Type>, class GrowthPolicy = default_growth, std::size_t ReaderSlots = 64>
+	class snapshot_vector {
+	public:
+		using allocator_type 	= Allocator;
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using const_reference = const Type&;
+		using const_pointer 	= const Type*;
+		using const_iterator 	= const Type*;
+
+		static_assert(ReaderSlots > 0, "snapshot_vector needs at least one reader slot");
+
+	private:
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		using pointer = typename allocatorTraits::pointer;
+
+		struct Buffer {
+			std::atomic<size_type> size{0};
+			size_type capacity{0};
+			pointer elements{nullptr};
+		};
+
+		using bufferAllocator = typename allocatorTraits::template rebind_alloc<Buffer>;
+		using bufferAllocatorTraits = std::allocator_traits<bufferAllocator>;
+
+		struct RetiredBuffer {
+			Buffer *buffer;
+			uint64_t epoch;
+		};
+
+		//One cache line each so readers don't share lines
+		struct alignas(64) ReaderSlot {
+			//0 while the slot is free
+			std::atomic<uint64_t> epoch{0};
+		};
+
+		allocator_type vectorAllocator;
+		std::atomic<Buffer*> currentBuffer{nullptr};
+		std::atomic<uint64_t> globalEpoch{1};
+		mutable ReaderSlot readerSlots[ReaderSlots];
+		vector<RetiredBuffer> retiredBuffers;
+
+		Buffer* createBuffer(size_type capacity) {
+			bufferAllocator headerAllocator(vectorAllocator);
+			Buffer *buffer = bufferAllocatorTraits::allocate(headerAllocator, 1);
+			bufferAllocatorTraits::construct(headerAllocator, buffer);
+			try {
+				buffer->elements = allocatorTraits::allocate(vectorAllocator, capacity);
+			} catch (...) {
+				bufferAllocatorTraits::destroy(headerAllocator, buffer);
+				bufferAllocatorTraits::deallocate(headerAllocator, buffer, 1);
+				throw;
+			}
+			buffer->capacity = capacity;
+			return buffer;
+		}
+
+		void destroyBuffer(Buffer *buffer) {
+			if (buffer == nullptr) {
+				return;
+			}
+			if constexpr (!std::is_trivially_destructible<value_type>::value) {
+				const size_type bufferSize = buffer->size.load(std::memory_order_relaxed);
+				for (size_type i=0; i<bufferSize; ++i) {
+					allocatorTraits::destroy(vectorAllocator, buffer->elements + i);
+				}
+			}
+			allocatorTraits::deallocate(vectorAllocator, buffer->elements, buffer->capacity);
+			bufferAllocator headerAllocator(vectorAllocator);
+			bufferAllocatorTraits::destroy(headerAllocator, buffer);
+			bufferAllocatorTraits::deallocate(headerAllocator, buffer, 1);
+		}
+
+		//A new buffer of newCapacity holding copies of the current elements, with transform(copy) applied
+		//	to the copy before it is published
+		template<class Transform>
+		void copyOnWrite(size_type newCapacity, size_type copyCount, Transform transform) {
+			Buffer *oldBuffer = currentBuffer.load(std::memory_order_relaxed);
+			Buffer *newBuffer = createBuffer(newCapacity);
+			size_type constructed = 0;
+			try {
+				for (; constructed<copyCount; ++constructed) {
+					allocatorTraits::construct(vectorAllocator, newBuffer->elements + constructed, oldBuffer->elements[constructed]);
+				}
+				newBuffer->size.store(copyCount, std::memory_order_relaxed);
+				transform(*newBuffer);
+			} catch (...) {
+				newBuffer->size.store(constructed, std::memory_order_relaxed);
+				destroyBuffer(newBuffer);
+				throw;
+			}
+			publish(newBuffer);
+		}
+
+		//Takes ownership of newBuffer, freeing it if it can't be published
+		void publish(Buffer *newBuffer) {
+			//Make room to retire the old buffer first, once readers can see newBuffer there is no going back
+			try {
+				if (retiredBuffers.size() == retiredBuffers.capacity()) {
+					retiredBuffers.reserve(golden_ratio_growth::next_capacity(retiredBuffers.capacity(), retiredBuffers.size() + 1, sizeof(RetiredBuffer)));
+				}
+			} catch (...) {
+				destroyBuffer(newBuffer);
+				throw;
+			}
+			Buffer *oldBuffer = currentBuffer.exchange(newBuffer, std::memory_order_seq_cst);
+			if (oldBuffer != nullptr) {
+				//Readers that could have seen oldBuffer pinned an epoch before this increment
+				const uint64_t retireEpoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+				retiredBuffers.push_back(RetiredBuffer{oldBuffer, retireEpoch});
+			}
+			reclaim();
+		}
+
+		size_type acquireSlot() const {
+			size_type slot = std::hash<std::thread::id>()(std::this_thread::get_id()) % ReaderSlots;
+			while (true) {
+				for (size_type attempt=0; attempt<ReaderSlots; ++attempt) {
+					uint64_t expected = 0;
+					const uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+					if (readerSlots[slot].epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst)) {
+						return slot;
+					}
+					slot = (slot + 1) % ReaderSlots;
+				}
+				std::this_thread::yield();
+			}
+		}
+
+		void releaseSlot(size_type slot) const {
+			readerSlots[slot].epoch.store(0, std::memory_order_release);
+		}
+
+	public:
+		//An immutable view of the elements at the time it was taken
+		class snapshot {
+		public:
+			snapshot(snapshot &&other) noexcept : owner(other.owner), slot(other.slot), elements(other.elements), elementCount(other.elementCount) {
+				other.owner = nullptr;
+			}
+
+			snapshot(const snapshot &other) = delete;
+			snapshot& operator=(const snapshot &other) = delete;
+			snapshot& operator=(snapshot &&other) = delete;
+
+			~snapshot() {
+				if (owner != nullptr) {
+					owner->releaseSlot(slot);
+				}
+			}
+
+			const_reference operator[](size_type pos) const {
+				return elements[pos];
+			}
+
+			const_reference at(size_type pos) const {
+				if (pos >= size()) {
+					throw std::out_of_range("snapshot_vector::snapshot::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+				}
+				return elements[pos];
+			}
+
+			const_pointer data() const {
+				return elements;
+			}
+
+			const_iterator begin() const {
+				return elements;
+			}
+
+			const_iterator end() const {
+				return elements + elementCount;
+			}
+
+			size_type size() const {
+				return elementCount;
+			}
+
+			bool empty() const {
+				return elementCount == 0;
+			}
+
+		private:
+			friend class snapshot_vector;
+
+			snapshot(const snapshot_vector *owner, size_type slot, const_pointer elements, size_type elementCount) : owner(owner), slot(slot), elements(elements), elementCount(elementCount) {}
+
+			const snapshot_vector *owner;
+			size_type slot;
+			const_pointer elements;
+			size_type elementCount;
+		};
+
+		snapshot_vector() : snapshot_vector(Allocator()) {}
+
+		explicit snapshot_vector(const Allocator &alloc) : vectorAllocator(alloc) {}
+
+		snapshot_vector(const snapshot_vector &other) = delete;
+		snapshot_vector& operator=(const snapshot_vector &other) = delete;
+
+		//No snapshots may be held any more
+		~snapshot_vector() {
+			destroyBuffer(currentBuffer.load(std::memory_order_relaxed));
+			for (auto &retired : retiredBuffers) {
+				destroyBuffer(retired.buffer);
+			}
+		}
+
+		allocator_type get_allocator() const {
+			return vectorAllocator;
+		}
+
+		//Safe to call from any thread
+		snapshot take_snapshot() const {
+			const size_type slot = acquireSlot();
+			Buffer *buffer = currentBuffer.load(std::memory_order_seq_cst);
+			if (buffer == nullptr) {
+				return snapshot(this, slot, nullptr, 0);
+			}
+			return snapshot(this, slot, buffer->elements, buffer->size.load(std::memory_order_acquire));
+		}
+
+		//The writer's view
+		const_reference operator[](size_type pos) const {
+			return currentBuffer.load(std::memory_order_relaxed)->elements[pos];
+		}
+
+		size_type size() const {
+			Buffer *buffer = currentBuffer.load(std::memory_order_relaxed);
+			return (buffer == nullptr ? 0 : buffer->size.load(std::memory_order_relaxed));
+		}
+
+		bool empty() const {
+			return size() == 0;
+		}
+
+		size_type capacity() const {
+			Buffer *buffer = currentBuffer.load(std::memory_order_relaxed);
+			return (buffer == nullptr ? 0 : buffer->capacity);
+		}
+
+		//Old buffers that are still waiting for readers to let go of them
+		size_type retired_buffers() const {
+			return retiredBuffers.size();
+		}
+
+		void reserve(size_type newCapacity) {
+			if (capacity() < newCapacity) {
+				copyOnWrite(newCapacity, size(), [](Buffer &) {});
+			}
+		}
+
+		void push_back(const value_type &obj) {
+			emplace_back(obj);
+		}
+
+		void push_back(value_type &&obj) {
+			emplace_back(std::move(obj));
+		}
+
+		template<class... Args>
+		void emplace_back(Args&&... args) {
+			Buffer *buffer = currentBuffer.load(std::memory_order_relaxed);
+			const size_type oldSize = size();
+			if (buffer != nullptr && oldSize < buffer->capacity) {
+				//No reader looks past the size it saw, so the new element can go straight in
+				allocatorTraits::construct(vectorAllocator, buffer->elements + oldSize, std::forward<Args>(args)...);
+				buffer->size.store(oldSize + 1, std::memory_order_release);
+				return;
+			}
+			const size_type newCapacity = GrowthPolicy::next_capacity(capacity(), oldSize + 1, sizeof(value_type));
+			copyOnWrite(newCapacity, oldSize, [&](Buffer &newBuffer) {
+				allocatorTraits::construct(vectorAllocator, newBuffer.elements + oldSize, std::forward<Args>(args)...);
+				newBuffer.size.store(oldSize + 1, std::memory_order_relaxed);
+			});
+		}
+
+		//Publishes a copy with the element at pos replaced
+		void replace(size_type pos, const value_type &value) {
+			if (pos >= size()) {
+				throw std::out_of_range("snapshot_vector::replace() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			copyOnWrite(capacity(), size(), [&](Buffer &newBuffer) {
+				newBuffer.elements[pos] = value;
+			});
+		}
+
+		void pop_back() {
+			copyOnWrite(capacity(), size() - 1, [](Buffer &) {});
+		}
+
+		void clear() {
+			Buffer *oldBuffer = currentBuffer.load(std::memory_order_relaxed);
+			if (oldBuffer != nullptr) {
+				publish(nullptr);
+			}
+		}
+
+		//Frees every retired buffer that no reader can still be looking at
+		void reclaim() {
+			uint64_t oldestPinned = std::numeric_limits<uint64_t>::max();
+			for (const auto &slot : readerSlots) {
+				const uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+				if (epoch != 0) {
+					oldestPinned = std::min(oldestPinned, epoch);
+				}
+			}
+			auto stillPinned = std::remove_if(retiredBuffers.begin(), retiredBuffers.end(), [&](const RetiredBuffer &retired) {
+				if (retired.epoch <= oldestPinned) {
+					destroyBuffer(retired.buffer);
+					return true;
+				}
+				return false;
+			});
+			retiredBuffers.erase(stillPinned, retiredBuffers.end());
+		}
+	};
+}
+
+#endif //SNAPSHOT_VECTOR_HPP
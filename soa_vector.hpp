@@ -0,0 +1,616 @@
+#ifndef SOA_VECTOR_HPP
+#define SOA_VECTOR_HPP 1
+
+#include <tuple>
+#include "vector.hpp"
+
+namespace sandsnip3r {
+
+	//A view of count contiguous elements, what a soa_vector column is handed out as
+	template<class Type>
+	class column_span {
+	public:
+		using value_type 	= std::remove_const_t<Type>;
+		using size_type 	= std::size_t;
+		using pointer 		= Type*;
+		using reference 	= Type&;
+		using iterator 		= Type*;
+
+		column_span() = default;
+
+		column_span(Type *first, size_type count) : first(first), count(count) {}
+
+		pointer data() const {
+			return first;
+		}
+
+		size_type size() const {
+			return count;
+		}
+
+		bool empty() const {
+			return count == 0;
+		}
+
+		reference operator[](size_type pos) const {
+			return first[pos];
+		}
+
+		iterator begin() const {
+			return first;
+		}
+
+		iterator end() const {
+			return first + count;
+		}
+
+	private:
+		Type *first{nullptr};
+		size_type count{0};
+	};
+
+	//A structure-of-arrays vector: row i is made of element i of every column, and each column is its
+	//	own contiguous array, so a pass over one or two fields only pulls those fields into cache
+	//All columns share the size and capacity and live in one allocation, each starting on a ColumnAlignment
+	//	boundary so column<I>().data() can be handed to vectorized kernels. Rows are read and written
+	//	through tuples of references, both from operator[] and from the iterators
+	//Allocator is rebound for the storage and for each column, so its value_type doesn't matter
+	template<class Allocator, class GrowthPolicy, std::size_t ColumnAlignment, class... Types>
+	class basic_soa_vector {
+		static_assert(sizeof...(Types) > 0, "soa_vector needs at least one column");
+		static_assert(ColumnAlignment != 0 && (ColumnAlignment & (ColumnAlignment - 1)) == 0, "soa_vector ColumnAlignment must be a power of two");
+
+	public:
+		using allocator_type 	= Allocator;
+		using value_type 			= std::tuple<Types...>;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= std::tuple<Types&...>;
+		using const_reference = std::tuple<const Types&...>;
+		using iterator 				= detail::indexed_iterator<basic_soa_vector, value_type, reference>;
+		using const_iterator 	= detail::indexed_iterator<const basic_soa_vector, const value_type, const_reference>;
+
+		static constexpr std::size_t COLUMN_COUNT = sizeof...(Types);
+
+		template<std::size_t I>
+		using column_type = std::tuple_element_t<I, value_type>;
+
+	private:
+		static constexpr std::size_t STORAGE_ALIGNMENT = std::max({ColumnAlignment, alignof(Types)...});
+		static constexpr std::size_t ROW_SIZE = (sizeof(Types) + ...);
+
+		struct alignas(STORAGE_ALIGNMENT) Block {
+			unsigned char bytes[STORAGE_ALIGNMENT];
+		};
+
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		using blockAllocator = typename allocatorTraits::template rebind_alloc<Block>;
+		using blockAllocatorTraits = std::allocator_traits<blockAllocator>;
+		template<std::size_t I>
+		using columnAllocator = typename allocatorTraits::template rebind_alloc<column_type<I>>;
+		template<std::size_t I>
+		using columnAllocatorTraits = std::allocator_traits<columnAllocator<I>>;
+		using columnPointers = std::tuple<Types*...>;
+
+		allocator_type vectorAllocator;
+		Block *storage{nullptr};
+		columnPointers columns{};
+		size_type dataSize{0};
+		size_type dataCapacity{0};
+
+		//Blocks holding capacity rows, with every column rounded up to the alignment
+		static size_type blocksFor(size_type capacity) {
+			return ((detail::roundUp(capacity * sizeof(Types), STORAGE_ALIGNMENT) / STORAGE_ALIGNMENT) + ...);
+		}
+
+		static columnPointers layColumns(Block *blocks, size_type capacity) {
+			columnPointers result;
+			layColumn<0>(result, blocks, capacity);
+			return result;
+		}
+
+		template<std::size_t I>
+		static void layColumn(columnPointers &result, Block *blocks, size_type capacity) {
+			if constexpr (I < COLUMN_COUNT) {
+				std::get<I>(result) = reinterpret_cast<column_type<I>*>(blocks);
+				layColumn<I + 1>(result, blocks + detail::roundUp(capacity * sizeof(column_type<I>), STORAGE_ALIGNMENT) / STORAGE_ALIGNMENT, capacity);
+			}
+		}
+
+		template<std::size_t I>
+		column_type<I>* columnData() const {
+			return std::get<I>(columns);
+		}
+
+		template<std::size_t I, class... Args>
+		void constructElement(column_type<I> *element, Args&&... args) {
+			columnAllocator<I> alloc(vectorAllocator);
+			columnAllocatorTraits<I>::construct(alloc, element, std::forward<Args>(args)...);
+		}
+
+		template<std::size_t I>
+		void destroyColumn(column_type<I> *first, column_type<I> *last) {
+			if constexpr (!std::is_trivially_destructible<column_type<I>>::value) {
+				columnAllocator<I> alloc(vectorAllocator);
+				for (; first != last; ++first) {
+					columnAllocatorTraits<I>::destroy(alloc, first);
+				}
+			}
+		}
+
+		template<std::size_t I = 0>
+		void destroyRows(size_type first, size_type last) {
+			if constexpr (I < COLUMN_COUNT) {
+				destroyColumn<I>(columnData<I>() + first, columnData<I>() + last);
+				destroyRows<I + 1>(first, last);
+			}
+		}
+
+		//Every column below is built the same way: column I is filled, then the following columns are
+		//	filled by recursing, and if they throw, column I is unwound again. So either every column gets
+		//	its elements or none do
+
+		//Constructs row index from the I'th of each tuple of arguments
+		template<std::size_t I = 0, class ArgsTuple>
+		void constructRow(size_type index, ArgsTuple &&args) {
+			if constexpr (I < COLUMN_COUNT) {
+				constructElement<I>(columnData<I>() + index, std::get<I>(std::forward<ArgsTuple>(args)));
+				try {
+					constructRow<I + 1>(index, std::forward<ArgsTuple>(args));
+				} catch (...) {
+					destroyColumn<I>(columnData<I>() + index, columnData<I>() + index + 1);
+					throw;
+				}
+			}
+		}
+
+		//Constructs rows [first, last) by calling constructColumn(std::integral_constant<I>, columnFirst, columnLast)
+		//	for each column I, which must construct all of them or none and throw
+		template<std::size_t I = 0, class ConstructColumn>
+		void constructRows(size_type first, size_type last, ConstructColumn constructColumn) {
+			if constexpr (I < COLUMN_COUNT) {
+				constructColumn(std::integral_constant<std::size_t, I>(), columnData<I>() + first, columnData<I>() + last);
+				try {
+					constructRows<I + 1>(first, last, constructColumn);
+				} catch (...) {
+					destroyColumn<I>(columnData<I>() + first, columnData<I>() + last);
+					throw;
+				}
+			}
+		}
+
+		//Builds [first, last) in a column with makeElement(element, index), destroying them again if one throws
+		template<std::size_t I, class MakeElement>
+		void constructColumnElements(column_type<I> *first, column_type<I> *last, MakeElement makeElement) {
+			column_type<I> *current = first;
+			try {
+				for (; current != last; ++current) {
+					makeElement(current, current - first);
+				}
+			} catch (...) {
+				destroyColumn<I>(first, current);
+				throw;
+			}
+		}
+
+		//Moves every column into newColumns. Columns that relocate without throwing are relocated on the way
+		//	back out of the recursion, after everything that can throw has succeeded. The others are copied
+		//	on the way in and their originals only destroyed at the end, so if a copy throws nothing changed
+		template<std::size_t I = 0>
+		void relocateColumns(columnPointers &newColumns) {
+			if constexpr (I < COLUMN_COUNT) {
+				column_type<I> *oldFirst = columnData<I>();
+				column_type<I> *newFirst = std::get<I>(newColumns);
+				columnAllocator<I> alloc(vectorAllocator);
+				if constexpr (detail::relocates_without_throwing<column_type<I>>) {
+					relocateColumns<I + 1>(newColumns);
+					detail::relocate(alloc, oldFirst, oldFirst + dataSize, newFirst);
+				} else {
+					detail::uninitializedMoveIfNoexcept(alloc, oldFirst, oldFirst + dataSize, newFirst);
+					try {
+						relocateColumns<I + 1>(newColumns);
+					} catch (...) {
+						destroyColumn<I>(newFirst, newFirst + dataSize);
+						throw;
+					}
+					destroyColumn<I>(oldFirst, oldFirst + dataSize);
+				}
+			}
+		}
+
+		void reallocate(size_type newCapacity) {
+			if (newCapacity > max_size()) {
+				throw std::length_error("soa_vector::reallocate() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
+			}
+			blockAllocator allocator(vectorAllocator);
+			const size_type newBlocks = blocksFor(newCapacity);
+			Block *newStorage = (newBlocks == 0 ? nullptr : blockAllocatorTraits::allocate(allocator, newBlocks));
+			columnPointers newColumns = layColumns(newStorage, newCapacity);
+			try {
+				relocateColumns(newColumns);
+			} catch (...) {
+				if (newStorage != nullptr) {
+					blockAllocatorTraits::deallocate(allocator, newStorage, newBlocks);
+				}
+				throw;
+			}
+			releaseStorage();
+			storage = newStorage;
+			columns = newColumns;
+			dataCapacity = newCapacity;
+		}
+
+		void releaseStorage() {
+			if (storage != nullptr) {
+				blockAllocator allocator(vectorAllocator);
+				blockAllocatorTraits::deallocate(allocator, storage, blocksFor(dataCapacity));
+			}
+			storage = nullptr;
+			columns = columnPointers();
+			dataCapacity = 0;
+		}
+
+		void reallocateIfNecessary() {
+			if (dataSize == dataCapacity) {
+				reallocate(GrowthPolicy::next_capacity(dataCapacity, dataSize + 1, ROW_SIZE));
+			}
+		}
+
+		void reallocateToNewSizeIfNecessary(size_type newCapacity) {
+			if (dataCapacity < newCapacity) {
+				reallocate(newCapacity);
+			}
+		}
+
+		template<std::size_t I = 0>
+		void eraseRows(size_type first, size_type last) {
+			if constexpr (I < COLUMN_COUNT) {
+				column_type<I> *column = columnData<I>();
+				if constexpr (is_trivially_relocatable_v<column_type<I>>) {
+					destroyColumn<I>(column + first, column + last);
+					std::memmove(static_cast<void*>(column + first), static_cast<const void*>(column + last), (dataSize - last) * sizeof(column_type<I>));
+				} else {
+					column_type<I> *newEnd = std::move(column + last, column + dataSize, column + first);
+					destroyColumn<I>(newEnd, column + dataSize);
+				}
+				eraseRows<I + 1>(first, last);
+			}
+		}
+
+		template<std::size_t... I>
+		reference rowAt(size_type index, std::index_sequence<I...>) {
+			return reference(columnData<I>()[index]...);
+		}
+
+		template<std::size_t... I>
+		const_reference rowAt(size_type index, std::index_sequence<I...>) const {
+			return const_reference(columnData<I>()[index]...);
+		}
+
+		template<std::size_t I = 0>
+		bool rowsEqual(const basic_soa_vector &other) const {
+			if constexpr (I < COLUMN_COUNT) {
+				return std::equal(columnData<I>(), columnData<I>() + dataSize, other.columnData<I>()) && rowsEqual<I + 1>(other);
+			} else {
+				return true;
+			}
+		}
+
+		void stealStorage(basic_soa_vector &other) {
+			storage = other.storage;
+			columns = other.columns;
+			dataSize = other.dataSize;
+			dataCapacity = other.dataCapacity;
+			other.storage = nullptr;
+			other.columns = columnPointers();
+			other.dataSize = other.dataCapacity = 0;
+		}
+
+		//Move-constructs other's rows into this vector, which must hold none
+		void moveRowsFrom(basic_soa_vector &other) {
+			reallocateToNewSizeIfNecessary(other.dataSize);
+			constructRows(0, other.dataSize, [&](auto column, auto *first, auto *last) {
+				constexpr std::size_t I = decltype(column)::value;
+				column_type<I> *source = other.columnData<I>();
+				constructColumnElements<I>(first, last, [&](column_type<I> *element, size_type index) {
+					constructElement<I>(element, std::move(source[index]));
+				});
+			});
+			dataSize = other.dataSize;
+		}
+
+	public:
+		basic_soa_vector() : basic_soa_vector(Allocator()) {}
+
+		explicit basic_soa_vector(const Allocator &alloc) : vectorAllocator(alloc) {}
+
+		explicit basic_soa_vector(size_type count, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			try {
+				resize(count);
+			} catch (...) {
+				releaseStorage();
+				throw;
+			}
+		}
+
+		basic_soa_vector(const basic_soa_vector &other) : basic_soa_vector(other, allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+		basic_soa_vector(const basic_soa_vector &other, const Allocator &alloc) : vectorAllocator(alloc) {
+			reallocate(other.dataSize);
+			try {
+				constructRows(0, other.dataSize, [&](auto column, auto *first, auto *last) {
+					constexpr std::size_t I = decltype(column)::value;
+					const column_type<I> *source = other.columnData<I>();
+					constructColumnElements<I>(first, last, [&](column_type<I> *element, size_type index) {
+						constructElement<I>(element, source[index]);
+					});
+				});
+			} catch (...) {
+				releaseStorage();
+				throw;
+			}
+			dataSize = other.dataSize;
+		}
+
+		basic_soa_vector(basic_soa_vector &&other) noexcept : vectorAllocator(std::move(other.vectorAllocator)) {
+			stealStorage(other);
+		}
+
+		~basic_soa_vector() {
+			clear();
+			releaseStorage();
+		}
+
+		basic_soa_vector& operator=(const basic_soa_vector &other) {
+			if (&other != this) {
+				//Copy into storage from the allocator we'll end up with, then release ours with the one it came from
+				basic_soa_vector copy(other, (allocatorTraits::propagate_on_container_copy_assignment::value ? other.vectorAllocator : vectorAllocator));
+				clear();
+				releaseStorage();
+				if (typename allocatorTraits::propagate_on_container_copy_assignment()) {
+					vectorAllocator = other.vectorAllocator;
+				}
+				stealStorage(copy);
+			}
+			return *this;
+		}
+
+		basic_soa_vector& operator=(basic_soa_vector &&other) noexcept(allocatorTraits::propagate_on_container_move_assignment::value || allocatorTraits::is_always_equal::value) {
+			if (&other != this) {
+				if (typename allocatorTraits::propagate_on_container_move_assignment() || vectorAllocator == other.vectorAllocator) {
+					clear();
+					releaseStorage();
+					if (typename allocatorTraits::propagate_on_container_move_assignment()) {
+						vectorAllocator = std::move(other.vectorAllocator);
+					}
+					stealStorage(other);
+				} else {
+					//Allocators are different and dont propigate
+					//keep current storage and move-construct all rows into it
+					clear();
+					moveRowsFrom(other);
+				}
+			}
+			return *this;
+		}
+
+		allocator_type get_allocator() const {
+			return vectorAllocator;
+		}
+
+		reference operator[](size_type pos) {
+			return rowAt(pos, std::index_sequence_for<Types...>());
+		}
+
+		const_reference operator[](size_type pos) const {
+			return rowAt(pos, std::index_sequence_for<Types...>());
+		}
+
+		reference at(size_type pos) {
+			if (pos >= size()) {
+				throw std::out_of_range("soa_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return (*this)[pos];
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= size()) {
+				throw std::out_of_range("soa_vector::at() pos (which is "+std::to_string(pos)+") >= size (which is "+std::to_string(size())+")");
+			}
+			return (*this)[pos];
+		}
+
+		reference front() {
+			return (*this)[0];
+		}
+
+		const_reference front() const {
+			return (*this)[0];
+		}
+
+		reference back() {
+			return (*this)[dataSize - 1];
+		}
+
+		const_reference back() const {
+			return (*this)[dataSize - 1];
+		}
+
+		//The I'th field of every row, contiguous and aligned to ColumnAlignment
+		template<std::size_t I>
+		column_span<column_type<I>> column() {
+			return column_span<column_type<I>>(columnData<I>(), dataSize);
+		}
+
+		template<std::size_t I>
+		column_span<const column_type<I>> column() const {
+			return column_span<const column_type<I>>(columnData<I>(), dataSize);
+		}
+
+		template<std::size_t I>
+		column_type<I>* data() {
+			return columnData<I>();
+		}
+
+		template<std::size_t I>
+		const column_type<I>* data() const {
+			return columnData<I>();
+		}
+
+		iterator begin() {
+			return iterator(this, 0);
+		}
+
+		const_iterator begin() const {
+			return const_iterator(this, 0);
+		}
+
+		const_iterator cbegin() const {
+			return const_iterator(this, 0);
+		}
+
+		iterator end() {
+			return iterator(this, dataSize);
+		}
+
+		const_iterator end() const {
+			return const_iterator(this, dataSize);
+		}
+
+		const_iterator cend() const {
+			return const_iterator(this, dataSize);
+		}
+
+		bool empty() const {
+			return dataSize == 0;
+		}
+
+		size_type size() const {
+			return dataSize;
+		}
+
+		size_type max_size() const {
+			const blockAllocator allocator(vectorAllocator);
+			const size_type maxBytes = std::min<size_type>(blockAllocatorTraits::max_size(allocator), std::numeric_limits<size_type>::max() / STORAGE_ALIGNMENT) * STORAGE_ALIGNMENT;
+			//Leave room for every column to be padded out to the alignment
+			return (maxBytes - COLUMN_COUNT * STORAGE_ALIGNMENT) / ROW_SIZE;
+		}
+
+		size_type capacity() const {
+			return dataCapacity;
+		}
+
+		void reserve(size_type newCapacity) {
+			reallocateToNewSizeIfNecessary(newCapacity);
+		}
+
+		void shrink_to_fit() {
+			if (dataSize < dataCapacity) {
+				reallocate(dataSize);
+			}
+		}
+
+		void clear() {
+			destroyRows(0, dataSize);
+			dataSize = 0;
+		}
+
+		void push_back(const value_type &row) {
+			emplaceRow(row);
+		}
+
+		void push_back(value_type &&row) {
+			emplaceRow(std::move(row));
+		}
+
+		//Appends a row with each column constructed from the matching argument
+		template<class... Args>
+		reference emplace_back(Args&&... args) {
+			static_assert(sizeof...(Args) == COLUMN_COUNT, "soa_vector::emplace_back() takes one argument per column");
+			return emplaceRow(std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		void pop_back() {
+			--dataSize;
+			destroyRows(dataSize, dataSize + 1);
+		}
+
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			const size_type firstIndex = first - cbegin();
+			const size_type lastIndex = last - cbegin();
+			if (firstIndex != lastIndex) {
+				eraseRows(firstIndex, lastIndex);
+				dataSize -= lastIndex - firstIndex;
+			}
+			return begin() + firstIndex;
+		}
+
+		//Value-initializes new rows
+		void resize(size_type count) {
+			if (dataSize < count) {
+				reallocateToNewSizeIfNecessary(count);
+				constructRows(dataSize, count, [&](auto column, auto *first, auto *last) {
+					constexpr std::size_t I = decltype(column)::value;
+					constructColumnElements<I>(first, last, [&](column_type<I> *element, size_type) {
+						constructElement<I>(element);
+					});
+				});
+				dataSize = count;
+			} else {
+				destroyRows(count, dataSize);
+				dataSize = count;
+			}
+		}
+
+		void swap(basic_soa_vector &other) noexcept(allocatorTraits::propagate_on_container_swap::value || allocatorTraits::is_always_equal::value) {
+			if (typename allocatorTraits::propagate_on_container_swap()) {
+				using std::swap;
+				swap(vectorAllocator, other.vectorAllocator);
+			}
+			swapStorage(other);
+		}
+
+		friend bool operator==(const basic_soa_vector &left, const basic_soa_vector &right) {
+			return left.dataSize == right.dataSize && left.rowsEqual(right);
+		}
+
+		friend bool operator!=(const basic_soa_vector &left, const basic_soa_vector &right) {
+			return !(left == right);
+		}
+
+		friend void swap(basic_soa_vector &left, basic_soa_vector &right) noexcept(noexcept(left.swap(right))) {
+			left.swap(right);
+		}
+
+	private:
+		template<class ArgsTuple>
+		reference emplaceRow(ArgsTuple &&args) {
+			if (dataSize == dataCapacity) {
+				//args may refer to one of our rows, which reallocating would move, so build the row first
+				value_type row(std::forward<ArgsTuple>(args));
+				reallocateIfNecessary();
+				constructRow(dataSize, std::move(row));
+			} else {
+				constructRow(dataSize, std::forward<ArgsTuple>(args));
+			}
+			++dataSize;
+			return back();
+		}
+
+		void swapStorage(basic_soa_vector &other) {
+			std::swap(storage, other.storage);
+			std::swap(columns, other.columns);
+			std::swap(dataSize, other.dataSize);
+			std::swap(dataCapacity, other.dataCapacity);
+		}
+	};
+
+	template<class... Types>
+	using soa_vector = basic_soa_vector<std::allocator<std::tuple<Types...>>, default_growth, 64, Types...>;
+}
+
+#endif //SOA_VECTOR_HPP
@@ -0,0 +1,327 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "vector.hpp"
+
+//Micro-benchmarks comparing sandsnip3r::vector against std::vector
+//	Results are printed to stdout as JSON, one entry per (benchmark, element type, container)
+//	Usage: ./benchmark [elementCount]
+
+//Count every heap allocation made by the benchmarked code
+//	noinline keeps GCC from seeing malloc and free paired with new and delete
+static uint64_t allocationCount = 0;
+
+__attribute__((noinline)) void* operator new(std::size_t size) {
+	++allocationCount;
+	if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+	std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+template <class Type>
+using Sandsnip3rVector = sandsnip3r::vector<Type>;
+
+template <class Type>
+using StdVector = std::vector<Type>;
+
+//Keep the optimizer from throwing away results
+template<class Type>
+void doNotOptimize(const Type &value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Pod64 {
+	uint64_t values[8];
+
+	friend bool operator==(const Pod64 &left, const Pod64 &right) {
+		for (int i=0; i<8; ++i) {
+			if (left.values[i] != right.values[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	friend bool operator!=(const Pod64 &left, const Pod64 &right) {
+		return !(left == right);
+	}
+
+	friend bool operator<(const Pod64 &left, const Pod64 &right) {
+		for (int i=0; i<8; ++i) {
+			if (left.values[i] != right.values[i]) {
+				return left.values[i] < right.values[i];
+			}
+		}
+		return false;
+	}
+};
+
+//Like TestObj in googleTest.cpp: every special member does a little work, so nothing is trivial
+class NonTrivialObj {
+public:
+	NonTrivialObj() = default;
+	NonTrivialObj(int num) : value(num) {}
+	NonTrivialObj(const NonTrivialObj &other) : value(other.value) {
+		++copies;
+	}
+	NonTrivialObj(NonTrivialObj &&other) noexcept : value(other.value) {
+		++moves;
+	}
+	~NonTrivialObj() {
+		++destructions;
+	}
+	NonTrivialObj& operator=(const NonTrivialObj &other) {
+		value = other.value;
+		++copies;
+		return *this;
+	}
+	NonTrivialObj& operator=(NonTrivialObj &&other) noexcept {
+		value = other.value;
+		++moves;
+		return *this;
+	}
+	friend bool operator==(const NonTrivialObj &left, const NonTrivialObj &right) {
+		return left.value == right.value;
+	}
+	friend bool operator!=(const NonTrivialObj &left, const NonTrivialObj &right) {
+		return !(left == right);
+	}
+	friend bool operator<(const NonTrivialObj &left, const NonTrivialObj &right) {
+		return left.value < right.value;
+	}
+	int value{0};
+	static uint64_t copies;
+	static uint64_t moves;
+	static uint64_t destructions;
+};
+
+uint64_t NonTrivialObj::copies;
+uint64_t NonTrivialObj::moves;
+uint64_t NonTrivialObj::destructions;
+
+template<class Type>
+Type makeValue(size_t i);
+
+template<>
+int makeValue<int>(size_t i) {
+	return static_cast<int>(i);
+}
+
+template<>
+Pod64 makeValue<Pod64>(size_t i) {
+	Pod64 value;
+	for (int j=0; j<8; ++j) {
+		value.values[j] = i + j;
+	}
+	return value;
+}
+
+template<>
+std::string makeValue<std::string>(size_t i) {
+	//Long enough to not fit in the small string buffer
+	return "benchmark string number " + std::to_string(i);
+}
+
+template<>
+NonTrivialObj makeValue<NonTrivialObj>(size_t i) {
+	return NonTrivialObj(static_cast<int>(i));
+}
+
+template<class Type>
+const char* typeName();
+
+template<>
+const char* typeName<int>() {
+	return "int";
+}
+
+template<>
+const char* typeName<Pod64>() {
+	return "Pod64";
+}
+
+template<>
+const char* typeName<std::string>() {
+	return "std::string";
+}
+
+template<>
+const char* typeName<NonTrivialObj>() {
+	return "NonTrivialObj";
+}
+
+template<template<class> class Vector>
+const char* containerName();
+
+template<>
+const char* containerName<Sandsnip3rVector>() {
+	return "sandsnip3r::vector";
+}
+
+template<>
+const char* containerName<StdVector>() {
+	return "std::vector";
+}
+
+struct Result {
+	double nsPerOp;
+	double allocationsPerOp;
+};
+
+//Run body (which performs opsPerRun operations) until enough time has passed to get a stable
+//	measurement, reporting the fastest run
+template<class Body>
+Result measure(size_t opsPerRun, Body body) {
+	using Clock = std::chrono::steady_clock;
+	const auto MIN_TOTAL_TIME = std::chrono::milliseconds(100);
+	const int MIN_RUNS = 5;
+
+	double bestNs = -1;
+	uint64_t allocations = 0;
+	auto totalStart = Clock::now();
+	for (int run=0; run<MIN_RUNS || Clock::now()-totalStart < MIN_TOTAL_TIME; ++run) {
+		const auto allocationsBefore = allocationCount;
+		const auto start = Clock::now();
+		body();
+		const auto end = Clock::now();
+		allocations = allocationCount - allocationsBefore;
+		const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+		if (bestNs < 0 || ns < bestNs) {
+			bestNs = ns;
+		}
+	}
+	return {bestNs / opsPerRun, static_cast<double>(allocations) / opsPerRun};
+}
+
+static bool firstResult = true;
+
+void report(const char *benchmark, const char *type, const char *container, size_t elements, const Result &result) {
+	std::printf("%s\n    {\"benchmark\": \"%s\", \"type\": \"%s\", \"container\": \"%s\", \"elements\": %zu, \"ns_per_op\": %.3f, \"allocations_per_op\": %.3f}",
+	            (firstResult ? "" : ","), benchmark, type, container, elements, result.nsPerOp, result.allocationsPerOp);
+	firstResult = false;
+}
+
+template<template<class> class Vector, class Type>
+void runBenchmarks(size_t count) {
+	const char *type = typeName<Type>();
+	const char *container = containerName<Vector>();
+
+	Vector<Type> source;
+	for (size_t i=0; i<count; ++i) {
+		source.push_back(makeValue<Type>(i));
+	}
+	const Type value = makeValue<Type>(count);
+
+	//One op is one push_back into a vector that starts empty
+	report("push_back", type, container, count, measure(count, [&]() {
+		Vector<Type> v;
+		for (size_t i=0; i<count; ++i) {
+			v.push_back(value);
+		}
+		doNotOptimize(v.data());
+	}));
+
+	report("emplace_back", type, container, count, measure(count, [&]() {
+		Vector<Type> v;
+		for (size_t i=0; i<count; ++i) {
+			v.emplace_back(source[i]);
+		}
+		doNotOptimize(v.data());
+	}));
+
+	report("reserve_fill", type, container, count, measure(count, [&]() {
+		Vector<Type> v;
+		v.reserve(count);
+		for (size_t i=0; i<count; ++i) {
+			v.push_back(value);
+		}
+		doNotOptimize(v.data());
+	}));
+
+	//One op is one whole-vector operation
+	report("copy_construct", type, container, count, measure(1, [&]() {
+		Vector<Type> v(source);
+		doNotOptimize(v.data());
+	}));
+
+	{
+		//One op is one move construction or one move assignment, the buffer is passed back and forth
+		Vector<Type> moving(source);
+		report("move", type, container, count, measure(2, [&]() {
+			Vector<Type> v(std::move(moving));
+			doNotOptimize(v.data());
+			moving = std::move(v);
+		}));
+	}
+
+	{
+		Vector<Type> v(source);
+		report("copy_assign", type, container, count, measure(1, [&]() {
+			v = source;
+			doNotOptimize(v.data());
+		}));
+	}
+
+	report("resize", type, container, count, measure(1, [&]() {
+		Vector<Type> v;
+		v.resize(count);
+		doNotOptimize(v.data());
+	}));
+
+	{
+		Vector<Type> other(source);
+		report("equal", type, container, count, measure(1, [&]() {
+			bool result = (source == other);
+			doNotOptimize(result);
+		}));
+
+		report("less", type, container, count, measure(1, [&]() {
+			bool result = (source < other);
+			doNotOptimize(result);
+		}));
+	}
+
+	//One op is visiting one element
+	report("iterate", type, container, count, measure(count, [&]() {
+		size_t visited = 0;
+		for (const auto &element : source) {
+			doNotOptimize(element);
+			++visited;
+		}
+		doNotOptimize(visited);
+	}));
+}
+
+template<class Type>
+void compare(size_t count) {
+	runBenchmarks<Sandsnip3rVector, Type>(count);
+	runBenchmarks<StdVector, Type>(count);
+}
+
+int main(int argc, char **argv) {
+	size_t count = 100000;
+	if (argc > 1) {
+		count = std::strtoull(argv[1], nullptr, 10);
+	}
+
+	std::printf("{\n  \"benchmarks\": [");
+	compare<int>(count);
+	compare<Pod64>(count);
+	compare<std::string>(count);
+	compare<NonTrivialObj>(count);
+	std::printf("\n  ]\n}\n");
+	return 0;
+}
@@ -1,6 +1,23 @@
+#include <atomic>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <string>
 #include "gtest/gtest.h"
 #include "vector.hpp"
+#include "small_vector.hpp"
+#include "compact_vector.hpp"
+#include "mapped_vector.hpp"
+#include "concurrent_vector.hpp"
+#include "segmented_vector.hpp"
+#include "incremental_vector.hpp"
+#include "snapshot_vector.hpp"
+#include "flat_map.hpp"
+#include "soa_vector.hpp"
 
 //Easily switch between my vector and the STL vector
 //	to ensure the test results are equivalent
@@ -77,6 +94,113 @@ void TestObj::resetCounts() {
 	destruction = 0;
 }
 
+//A non-trivial type that opts in to being relocated with memcpy
+//	its move constructor should never be called when the vector grows
+class RelocatableObj {
+public:
+	RelocatableObj(int num) : value(num) {}
+	RelocatableObj(RelocatableObj &&other) noexcept : value(other.value) {
+		++moveConstruction;
+	}
+	~RelocatableObj() {
+		++destruction;
+	}
+	int value;
+	static uint64_t moveConstruction;
+	static uint64_t destruction;
+	static void resetCounts() {
+		moveConstruction = 0;
+		destruction = 0;
+	}
+};
+
+uint64_t RelocatableObj::moveConstruction;
+uint64_t RelocatableObj::destruction;
+
+namespace sandsnip3r {
+	template<>
+	struct is_trivially_relocatable<RelocatableObj> : std::true_type {};
+}
+
+//Its move constructor may throw, so growth has to copy to keep the strong exception guarantee
+class ThrowingMoveObj {
+public:
+	ThrowingMoveObj(int num = 0) : value(num) {}
+	ThrowingMoveObj(const ThrowingMoveObj &other) : value(other.value) {
+		if (copiesUntilThrow-- == 0) {
+			throw std::runtime_error("ThrowingMoveObj copy failed");
+		}
+		++copies;
+	}
+	ThrowingMoveObj(ThrowingMoveObj &&other) : value(other.value) {
+		++moves;
+	}
+	ThrowingMoveObj& operator=(const ThrowingMoveObj &other) = default;
+	int value;
+	static int copies;
+	static int moves;
+	static int copiesUntilThrow;
+};
+
+int ThrowingMoveObj::copies;
+int ThrowingMoveObj::moves;
+int ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+
+//Counts the allocations made through it, and can be told to fail after a number of them
+//	Allocators with different ids compare unequal and, like std::allocator, never propagate
+struct AllocationCounts {
+	static uint64_t allocations;
+	static uint64_t deallocations;
+	static int64_t allocationsUntilThrow;
+	static void resetCounts() {
+		allocations = 0;
+		deallocations = 0;
+		allocationsUntilThrow = std::numeric_limits<int64_t>::max();
+	}
+};
+
+uint64_t AllocationCounts::allocations;
+uint64_t AllocationCounts::deallocations;
+int64_t AllocationCounts::allocationsUntilThrow = std::numeric_limits<int64_t>::max();
+
+template <class Type>
+class CountingAllocator {
+public:
+	using value_type = Type;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = Type&;
+	using const_reference = const Type&;
+	using pointer = Type*;
+	using const_pointer = const Type*;
+	template<class Other>
+	struct rebind {
+		using other = CountingAllocator<Other>;
+	};
+	CountingAllocator() = default;
+	explicit CountingAllocator(int id) : id(id) {}
+	template<class Other>
+	CountingAllocator(const CountingAllocator<Other> &other) : id(other.id) {}
+	Type* allocate(std::size_t count) {
+		if (AllocationCounts::allocationsUntilThrow-- == 0) {
+			throw std::bad_alloc();
+		}
+		++AllocationCounts::allocations;
+		return std::allocator<Type>().allocate(count);
+	}
+	void deallocate(Type *data, std::size_t count) {
+		++AllocationCounts::deallocations;
+		std::allocator<Type>().deallocate(data, count);
+	}
+	friend bool operator==(const CountingAllocator &left, const CountingAllocator &right) {
+		return left.id == right.id;
+	}
+	friend bool operator!=(const CountingAllocator &left, const CountingAllocator &right) {
+		return left.id != right.id;
+	}
+	int id{0};
+};
+
 TEST(Construction, defaultConstruction) {
 	Vector<int> v;
 	ASSERT_TRUE(v.empty());
@@ -193,6 +317,33 @@ TEST(Construction, iteratorConstructionWithCounts) {
 	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
 }
 
+TEST(Construction, iteratorConstructionAllocatesOnce) {
+	const size_t CREATE_COUNT = 1000;
+
+	std::list<int> list(CREATE_COUNT);
+	std::iota(list.begin(), list.end(), 0);
+	AllocationCounts::resetCounts();
+	sandsnip3r::vector<int, CountingAllocator<int>> v(list.begin(), list.end());
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	ASSERT_EQ(v.capacity(), CREATE_COUNT);
+	ASSERT_EQ(AllocationCounts::allocations, 1);
+	ASSERT_TRUE(std::equal(v.begin(), v.end(), list.begin()));
+
+	//Copied as a block
+	sandsnip3r::vector<int, CountingAllocator<int>> copy(v.begin(), v.end());
+	ASSERT_EQ(AllocationCounts::allocations, 2);
+	ASSERT_EQ(copy, v);
+}
+
+TEST(Construction, inputIteratorConstruction) {
+	std::istringstream stream("1 2 3 4 5 6 7 8 9 10");
+	Vector<int> v(std::istream_iterator<int>(stream), (std::istream_iterator<int>()));
+	ASSERT_EQ(v.size(), 10);
+	for (int i=0; i<10; ++i) {
+		ASSERT_EQ(v[i], i + 1);
+	}
+}
+
 TEST(Construction, initializerListConstruction) {
 	Vector<int> v{0, 1, 2, 3, 4};
 
@@ -329,6 +480,56 @@ TEST(Assignment, copyAssignmentWithCount) {
 	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
 }
 
+TEST(Assignment, copyAssignmentReusesElements) {
+	const size_t CREATE_COUNT = 10;
+	Vector<TestObj> source(CREATE_COUNT);
+	Vector<TestObj> v(CREATE_COUNT);
+
+	TestObj::resetCounts();
+	v = source;
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::copyAssignment, CREATE_COUNT);
+	ASSERT_EQ(TestObj::destruction, 0);
+
+	//Shrinking destroys only the surplus, growing within capacity constructs only the difference
+	Vector<TestObj> smaller(CREATE_COUNT / 2);
+	TestObj::resetCounts();
+	v = smaller;
+	ASSERT_EQ(TestObj::copyAssignment, CREATE_COUNT / 2);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT / 2);
+	TestObj::resetCounts();
+	v = source;
+	ASSERT_EQ(TestObj::copyAssignment, CREATE_COUNT / 2);
+	ASSERT_EQ(TestObj::copyConstruction, CREATE_COUNT / 2);
+	ASSERT_EQ(TestObj::destruction, 0);
+
+	//Inner buffers are kept
+	Vector<Vector<int>> nested(3, Vector<int>(100, 1));
+	const Vector<Vector<int>> replacement(3, Vector<int>(50, 2));
+	const int *innerData = nested[1].data();
+	nested = replacement;
+	ASSERT_EQ(nested[1].data(), innerData);
+	ASSERT_EQ(nested, replacement);
+
+	Vector<int> ints{1, 2, 3, 4};
+	ints = {5, 6};
+	ASSERT_EQ(ints, Vector<int>({5, 6}));
+	ASSERT_EQ(ints.capacity(), 4);
+}
+
+TEST(Assignment, copyAssignmentPropagatesAllocator) {
+	sandsnip3r::arena firstArena;
+	sandsnip3r::arena secondArena;
+	sandsnip3r::vector<int, sandsnip3r::arena_allocator<int>> v(100, 1, sandsnip3r::arena_allocator<int>(firstArena));
+	const sandsnip3r::vector<int, sandsnip3r::arena_allocator<int>> other(10, 2, sandsnip3r::arena_allocator<int>(secondArena));
+	v = other;
+	ASSERT_TRUE(v.get_allocator() == other.get_allocator());
+	ASSERT_EQ(v, other);
+	firstArena.release();
+	v.push_back(3);
+	ASSERT_EQ(v.size(), 11);
+}
+
 TEST(Assignment, moveAssignment) {
 	const size_t CREATE_COUNT = 10;
 	const int DEFAULT_VALUE = 987654321;
@@ -368,6 +569,53 @@ TEST(Assignment, moveAssignmentWithCount) {
 	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
 }
 
+TEST(Assignment, assign) {
+	Vector<int> v{1, 2, 3};
+	v.assign(5, 7);
+	ASSERT_EQ(v, Vector<int>({7, 7, 7, 7, 7}));
+	v.assign(2, v[0]);
+	ASSERT_EQ(v, Vector<int>({7, 7}));
+	v.assign({4, 5, 6});
+	ASSERT_EQ(v, Vector<int>({4, 5, 6}));
+
+	const std::list<int> list{9, 8, 7, 6};
+	v.assign(list.begin(), list.end());
+	ASSERT_EQ(v, Vector<int>({9, 8, 7, 6}));
+
+	std::istringstream stream("1 2 3");
+	v.assign(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+	ASSERT_EQ(v, Vector<int>({1, 2, 3}));
+
+	sandsnip3r::small_vector<int, 4> small;
+	small.assign({1, 2});
+	ASSERT_EQ(small.size(), 2);
+	small.assign(list.begin(), list.end());
+	small.assign(10, 3);
+	ASSERT_EQ(small.size(), 10);
+	ASSERT_EQ(small[9], 3);
+}
+
+TEST(Assignment, assignWithCount) {
+	const size_t CREATE_COUNT = 10;
+	std::vector<TestObj> source(CREATE_COUNT);
+	Vector<TestObj> v(CREATE_COUNT / 2);
+
+	TestObj::resetCounts();
+	v.assign(source.begin(), source.end());
+	ASSERT_EQ(TestObj::copyConstruction, CREATE_COUNT);
+	ASSERT_EQ(TestObj::moveConstruction, 0);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT / 2);
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+}
+
+TEST(Assignment, rangeConstructionCleansUp) {
+	ThrowingMoveObj::copiesUntilThrow = 5;
+	const std::vector<ThrowingMoveObj> source(10);
+	//Every element that was built is destroyed and the buffer released (checked by the sanitizers)
+	ASSERT_THROW((Vector<ThrowingMoveObj>(source.begin(), source.end())), std::runtime_error);
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+}
+
 TEST(ElementAccess, atBeyondBounds) {
 	Vector<int> v;
 
@@ -479,6 +727,146 @@ TEST(Capacity, resizeUpByAdding) {
 	}
 }
 
+TEST(Capacity, resizeUpByAddingTriviallyCopyable) {
+	struct Pod {
+		int a;
+		double b;
+	};
+	const int CREATE_COUNT = 1000;
+
+	Vector<Pod> v;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(Pod{i, i*0.5});
+	}
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(v[i].a, i);
+		ASSERT_EQ(v[i].b, i*0.5);
+	}
+}
+
+TEST(Capacity, resizeUpByAddingTriviallyRelocatableWithCount) {
+	const int CREATE_COUNT = 1000;
+
+	RelocatableObj::resetCounts();
+	{
+		sandsnip3r::vector<RelocatableObj> v;
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			v.emplace_back(i);
+		}
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			ASSERT_EQ(v[i].value, i);
+		}
+		//Growing relocates the elements without moving or destroying them
+		ASSERT_EQ(RelocatableObj::moveConstruction, 0);
+		ASSERT_EQ(RelocatableObj::destruction, 0);
+	}
+	ASSERT_EQ(RelocatableObj::destruction, CREATE_COUNT);
+}
+
+TEST(Capacity, growWithMallocAllocator) {
+	//Small mmap threshold so that growth crosses from malloc to mmap and then grows with mremap
+	using Allocator = sandsnip3r::malloc_allocator<int, 4096>;
+	const int CREATE_COUNT = 100000;
+
+	sandsnip3r::vector<int, Allocator> v;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(i);
+	}
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(v[i], i);
+	}
+	v.resize(10);
+	v.shrink_to_fit();
+	ASSERT_EQ(v.capacity(), 10);
+	for (int i=0; i<10; ++i) {
+		ASSERT_EQ(v[i], i);
+	}
+}
+
+TEST(Capacity, growWithMallocAllocatorWithCount) {
+	using Allocator = sandsnip3r::malloc_allocator<TestObj, 4096>;
+	const size_t CREATE_COUNT = 10000;
+
+	TestObj::resetCounts();
+	{
+		sandsnip3r::vector<TestObj, Allocator> v;
+		for (size_t i=0; i<CREATE_COUNT; ++i) {
+			v.emplace_back();
+		}
+		//Whether or not the buffer could be expanded in place, nothing is copied
+		ASSERT_EQ(TestObj::copyConstruction, 0);
+		ASSERT_EQ(TestObj::defaultConstruction, CREATE_COUNT);
+	}
+	ASSERT_EQ(TestObj::destruction, TestObj::defaultConstruction + TestObj::moveConstruction);
+}
+
+TEST(Capacity, growWithAlignedAllocator) {
+	const int CREATE_COUNT = 1 << 20;
+	sandsnip3r::vector<char, sandsnip3r::aligned_allocator<char>> small;
+	sandsnip3r::vector<int, sandsnip3r::aligned_allocator<int, 4096, (std::size_t(2) << 20), true>> large;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		small.push_back(static_cast<char>(i));
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(small.data()) % 64, 0);
+		large.push_back(i);
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(large.data()) % 4096, 0);
+	}
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(large[i], i);
+	}
+#ifdef __linux__
+	//Mapped buffers start on a huge page boundary
+	large.reserve(large.capacity() * 2);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(large.data()) % (std::size_t(2) << 20), 0);
+	ASSERT_EQ(large[CREATE_COUNT-1], CREATE_COUNT-1);
+#endif
+}
+
+TEST(Capacity, growthPolicies) {
+	ASSERT_EQ(sandsnip3r::golden_ratio_growth::next_capacity<size_t>(0, 1, 4), 1);
+	ASSERT_EQ(sandsnip3r::golden_ratio_growth::next_capacity<size_t>(1, 2, 4), 2);
+	ASSERT_EQ(sandsnip3r::golden_ratio_growth::next_capacity<size_t>(8, 9, 4), 13);
+	ASSERT_EQ(sandsnip3r::golden_ratio_growth::next_capacity<size_t>(1000, 1001, 4), 1625);
+	ASSERT_EQ(sandsnip3r::doubling_growth::next_capacity<size_t>(8, 9, 4), 16);
+	//Never overflows
+	const auto MAX = std::numeric_limits<size_t>::max();
+	ASSERT_EQ(sandsnip3r::doubling_growth::next_capacity<size_t>(MAX-1, MAX, 1), MAX);
+
+	using CacheLine = sandsnip3r::cache_line_first_growth<>;
+	ASSERT_EQ(CacheLine::next_capacity<size_t>(0, 1, 4), 16);
+	ASSERT_EQ(CacheLine::next_capacity<size_t>(0, 1, 1000), 1);
+	ASSERT_EQ(CacheLine::next_capacity<size_t>(16, 17, 4), 26);
+
+	//The default skips golden ratio growth's slow start
+	sandsnip3r::vector<int> v;
+	v.push_back(0);
+	ASSERT_EQ(v.capacity(), 16);
+
+	using Page = sandsnip3r::page_aligned_growth<sandsnip3r::doubling_growth, 4096, 4096>;
+	ASSERT_EQ(Page::next_capacity<size_t>(100, 101, 4), 200);
+	ASSERT_EQ(Page::next_capacity<size_t>(1000, 1001, 4), 2048);
+
+	using SizeClass = sandsnip3r::size_class_growth<sandsnip3r::doubling_growth>;
+	//5 and 12 bytes both fit in the smallest chunk (24 usable bytes), 40 bytes fit exactly
+	ASSERT_EQ(SizeClass::next_capacity<size_t>(0, 5, 1), 24);
+	ASSERT_EQ(SizeClass::next_capacity<size_t>(0, 3, 4), 6);
+	ASSERT_EQ(SizeClass::next_capacity<size_t>(0, 5, 8), 5);
+}
+
+TEST(Capacity, resizeUpByAddingWithGrowthPolicy) {
+	sandsnip3r::vector<int, std::allocator<int>, sandsnip3r::cache_line_first_growth<sandsnip3r::doubling_growth>> v;
+	v.push_back(0);
+	ASSERT_EQ(v.capacity(), 16);
+	for (int i=1; i<17; ++i) {
+		v.push_back(i);
+	}
+	ASSERT_EQ(v.capacity(), 32);
+	for (int i=0; i<17; ++i) {
+		ASSERT_EQ(v[i], i);
+	}
+}
+
 TEST(Capacity, shrinkToFit) {
 	const size_t CREATE_COUNT = 10;
 	const size_t RESERVE_AMOUNT = 100;
@@ -568,6 +956,52 @@ TEST(Resize, resizeUpCopyConstruct) {
 	}
 }
 
+TEST(Resize, resizeForOverwrite) {
+	const size_t CREATE_COUNT = 1000;
+
+	sandsnip3r::vector<char> v(10, 'a');
+	v.resize_for_overwrite(CREATE_COUNT);
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	ASSERT_EQ(v[9], 'a');
+	std::memset(v.data() + 10, 'b', CREATE_COUNT - 10);
+	ASSERT_EQ(v[CREATE_COUNT-1], 'b');
+
+	v.resize_for_overwrite(5);
+	ASSERT_EQ(v.size(), 5);
+
+	sandsnip3r::vector<float> buffer(CREATE_COUNT, sandsnip3r::default_init);
+	ASSERT_EQ(buffer.size(), CREATE_COUNT);
+	ASSERT_GE(buffer.capacity(), CREATE_COUNT);
+}
+
+TEST(Resize, resizeForOverwriteWithCounts) {
+	const size_t CREATE_COUNT_1 = 10;
+	const size_t CREATE_COUNT_2 = 20;
+
+	sandsnip3r::vector<TestObj> v(CREATE_COUNT_1);
+	v.reserve(CREATE_COUNT_2);
+
+	TestObj::resetCounts();
+	v.resize_for_overwrite(CREATE_COUNT_2);
+	//Non-trivial types still have their default constructor run
+	ASSERT_EQ(TestObj::defaultConstruction, CREATE_COUNT_2 - CREATE_COUNT_1);
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::moveConstruction, 0);
+	ASSERT_EQ(TestObj::destruction, 0);
+}
+
+TEST(Resize, resizeAndOverwrite) {
+	const std::string text = "hello world";
+
+	sandsnip3r::vector<char> v{'>', ' '};
+	v.resize_and_overwrite(100, [&](char *buffer, size_t) {
+		std::memcpy(buffer + 2, text.data(), text.size());
+		return 2 + text.size();
+	});
+	ASSERT_EQ(v.size(), 2 + text.size());
+	ASSERT_EQ(std::string(v.begin(), v.end()), "> hello world");
+}
+
 TEST(Swap, memberSwapBothNonEmpty) {
 	const size_t CREATE_COUNT_1 = 10;
 	const size_t CREATE_COUNT_2 = 500;
@@ -752,6 +1186,262 @@ TEST(Comparison, sameSizeDifferentCapacity) {
 	ASSERT_TRUE(v1>=v2);
 }
 
+TEST(Insertion, insertSingle) {
+	Vector<int> v{1, 2, 4};
+	auto it = v.insert(v.begin() + 2, 3);
+	ASSERT_EQ(*it, 3);
+	it = v.insert(v.begin(), 0);
+	ASSERT_EQ(it, v.begin());
+	v.insert(v.end(), 5);
+	ASSERT_EQ(v, (Vector<int>{0, 1, 2, 3, 4, 5}));
+}
+
+TEST(Insertion, insertCount) {
+	Vector<int> v{1, 5};
+	v.reserve(10);
+	auto it = v.insert(v.begin() + 1, 3, 7);
+	ASSERT_EQ(it - v.begin(), 1);
+	ASSERT_EQ(v, (Vector<int>{1, 7, 7, 7, 5}));
+	//Now with a reallocation
+	v.insert(v.begin(), 10, 0);
+	ASSERT_EQ(v.size(), 15);
+	ASSERT_EQ(v[9], 0);
+	ASSERT_EQ(v[10], 1);
+	ASSERT_EQ(v[14], 5);
+}
+
+TEST(Insertion, insertElementOfSelf) {
+	Vector<std::string> v{"a", "b", "c"};
+	v.insert(v.begin(), v[2]);
+	ASSERT_EQ(v, (Vector<std::string>{"c", "a", "b", "c"}));
+	v.reserve(10);
+	v.insert(v.begin(), 2, v[3]);
+	ASSERT_EQ(v, (Vector<std::string>{"c", "c", "c", "a", "b", "c"}));
+
+	Vector<int> ints{1, 2, 3};
+	ints.reserve(10);
+	ints.insert(ints.begin(), 2, ints[2]);
+	ASSERT_EQ(ints, (Vector<int>{3, 3, 1, 2, 3}));
+	ints.emplace(ints.begin(), ints[4]);
+	ASSERT_EQ(ints, (Vector<int>{3, 3, 3, 1, 2, 3}));
+}
+
+TEST(Insertion, insertRange) {
+	std::vector<std::string> source{"x", "y", "z"};
+	Vector<std::string> v{"a", "b"};
+	auto it = v.insert(v.begin() + 1, source.begin(), source.end());
+	ASSERT_EQ(*it, "x");
+	ASSERT_EQ(v, (Vector<std::string>{"a", "x", "y", "z", "b"}));
+	v.reserve(20);
+	v.insert(v.end() - 1, source.begin(), source.end());
+	ASSERT_EQ(v, (Vector<std::string>{"a", "x", "y", "z", "x", "y", "z", "b"}));
+	v.insert(v.begin(), {"0", "1"});
+	ASSERT_EQ(v.size(), 10);
+	ASSERT_EQ(v.front(), "0");
+}
+
+TEST(Insertion, insertInputRange) {
+	std::istringstream stream("3 4 5");
+	Vector<int> v{1, 2, 6};
+	auto it = v.insert(v.begin() + 2, std::istream_iterator<int>(stream), std::istream_iterator<int>());
+	ASSERT_EQ(*it, 3);
+	ASSERT_EQ(v, (Vector<int>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(Insertion, insertRangeWithCount) {
+	const size_t CREATE_COUNT = 10;
+	const size_t INSERT_COUNT = 5;
+	std::vector<TestObj> source(INSERT_COUNT);
+	Vector<TestObj> v(CREATE_COUNT);
+
+	TestObj::resetCounts();
+	v.insert(v.begin() + 3, source.begin(), source.end());
+	//New elements are copied straight into the new buffer and old elements are moved there once
+	ASSERT_EQ(TestObj::copyConstruction, INSERT_COUNT);
+	ASSERT_EQ(TestObj::moveConstruction, CREATE_COUNT);
+	ASSERT_EQ(TestObj::copyAssignment, 0);
+	ASSERT_EQ(TestObj::moveAssignment, 0);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
+	ASSERT_EQ(v.size(), CREATE_COUNT + INSERT_COUNT);
+}
+
+TEST(Insertion, insertTriviallyRelocatableWithCount) {
+	const int CREATE_COUNT = 10;
+	sandsnip3r::vector<RelocatableObj> v;
+	v.reserve(CREATE_COUNT + 1);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.emplace_back(i);
+	}
+
+	RelocatableObj::resetCounts();
+	v.emplace(v.begin(), -1);
+	//The tail is shifted with memmove
+	ASSERT_EQ(RelocatableObj::moveConstruction, 1);
+	ASSERT_EQ(RelocatableObj::destruction, 1);
+	for (int i=0; i<=CREATE_COUNT; ++i) {
+		ASSERT_EQ(v[i].value, i-1);
+	}
+}
+
+TEST(Insertion, emplace) {
+	Vector<std::pair<int, std::string>> v;
+	v.emplace(v.begin(), 2, "two");
+	v.emplace(v.begin(), 1, "one");
+	v.emplace(v.end(), 3, "three");
+	ASSERT_EQ(v.size(), 3);
+	ASSERT_EQ(v[0].second, "one");
+	ASSERT_EQ(v[1].second, "two");
+	ASSERT_EQ(v[2].second, "three");
+}
+
+TEST(Insertion, emplaceElementOfSelfAtEnd) {
+	const std::string LONG_STRING(100, 'x');
+
+	//Growing must not free the element the new one is built from
+	Vector<std::string> v{LONG_STRING};
+	ASSERT_EQ(v.size(), v.capacity());
+	v.emplace(v.cend(), v[0]);
+	ASSERT_EQ(v.size(), 2);
+	ASSERT_EQ(v[1], LONG_STRING);
+	v.shrink_to_fit();
+	v.push_back(v[1]);
+	ASSERT_EQ(v.back(), LONG_STRING);
+
+	//Also when the allocator grows the buffer itself
+	sandsnip3r::vector<int, sandsnip3r::malloc_allocator<int>> ints{7};
+	ints.emplace(ints.cend(), ints[0]);
+	ASSERT_EQ(ints, (sandsnip3r::vector<int, sandsnip3r::malloc_allocator<int>>{7, 7}));
+	sandsnip3r::arena arena;
+	sandsnip3r::vector<std::string, sandsnip3r::arena_allocator<std::string>> arenaStrings{sandsnip3r::arena_allocator<std::string>(arena)};
+	arenaStrings.push_back(LONG_STRING);
+	arenaStrings.emplace_back(arenaStrings[0]);
+	ASSERT_EQ(arenaStrings[1], LONG_STRING);
+}
+
+TEST(Insertion, pushBackUnchecked) {
+	const size_t CREATE_COUNT = 100;
+	Vector<std::string> v;
+	v.reserve(CREATE_COUNT + 1);
+	const auto *data = v.data();
+	for (size_t i=0; i<CREATE_COUNT; ++i) {
+		v.push_back_unchecked(std::to_string(i));
+	}
+	ASSERT_EQ(v.emplace_back_unchecked(), "");
+	ASSERT_EQ(v.data(), data);
+	ASSERT_EQ(v.size(), CREATE_COUNT + 1);
+	ASSERT_EQ(v[42], "42");
+}
+
+TEST(Insertion, appendN) {
+	const size_t CREATE_COUNT = 1000;
+	Vector<int> v{-1};
+	v.append_n(CREATE_COUNT, [](size_t i) {
+		return static_cast<int>(i * i);
+	});
+	ASSERT_EQ(v.size(), CREATE_COUNT + 1);
+	ASSERT_EQ(v[0], -1);
+	ASSERT_EQ(v[10], 81);
+
+	//Called in order, even for non-trivial elements
+	Vector<std::string> strings;
+	std::string text;
+	strings.append_n(5, [&](size_t) {
+		text += 'a';
+		return text;
+	});
+	ASSERT_EQ(strings[4], "aaaaa");
+}
+
+TEST(Insertion, appendRange) {
+	Vector<int> v{1, 2};
+	const std::list<int> list{3, 4};
+	v.append_range(list);
+	ASSERT_EQ(v, Vector<int>({1, 2, 3, 4}));
+
+	//Appending to itself, even when that reallocates
+	v.shrink_to_fit();
+	v.append_range(v);
+	ASSERT_EQ(v, Vector<int>({1, 2, 3, 4, 1, 2, 3, 4}));
+
+	std::istringstream stream("5 6");
+	struct {
+		std::istringstream &stream;
+		std::istream_iterator<int> begin() const { return std::istream_iterator<int>(stream); }
+		std::istream_iterator<int> end() const { return std::istream_iterator<int>(); }
+	} inputRange{stream};
+	v.append_range(inputRange);
+	ASSERT_EQ(v.size(), 10);
+	ASSERT_EQ(v.back(), 6);
+
+	Vector<std::string> strings{"a", "b"};
+	strings.shrink_to_fit();
+	strings.append_range(strings);
+	ASSERT_EQ(strings, Vector<std::string>({"a", "b", "a", "b"}));
+}
+
+TEST(Comparison, largeBitwiseComparable) {
+	const size_t CREATE_COUNT = 10000;
+	Vector<int> v1(CREATE_COUNT, 5);
+	Vector<int> v2(CREATE_COUNT, 5);
+	ASSERT_TRUE(v1==v2);
+	ASSERT_FALSE(v1<v2);
+
+	//Differ deep inside, past several memcmp blocks
+	v2[7777] = -1;
+	ASSERT_FALSE(v1==v2);
+	ASSERT_TRUE(v2<v1);
+	ASSERT_TRUE(v2<=v1);
+	ASSERT_TRUE(v1>v2);
+	ASSERT_FALSE(v1<=v2);
+
+	//Same prefix, shorter is less
+	Vector<int> v3(CREATE_COUNT - 1, 5);
+	ASSERT_TRUE(v3<v1);
+}
+
+TEST(Comparison, bytes) {
+	Vector<unsigned char> u1{1, 2, 200};
+	Vector<unsigned char> u2{1, 2, 3, 4};
+	ASSERT_TRUE(u2<u1);
+	ASSERT_FALSE(u1==u2);
+
+	//memcmp would treat -1 as 255
+	Vector<signed char> s1{1, -1};
+	Vector<signed char> s2{1, 1};
+	ASSERT_TRUE(s1<s2);
+
+	Vector<std::byte> b1{std::byte{1}, std::byte{0xff}};
+	Vector<std::byte> b2{std::byte{1}, std::byte{0x0f}};
+	ASSERT_TRUE(b2<b1);
+}
+
+TEST(Comparison, nonTrivialElements) {
+	Vector<std::string> v1{"apple", "banana", "cherry"};
+	Vector<std::string> v2{"apple", "banana", "date"};
+	ASSERT_FALSE(v1==v2);
+	ASSERT_TRUE(v1<v2);
+	ASSERT_TRUE(v2>=v1);
+
+	//NaN is neither less nor greater, so comparison continues past it
+	const double NAN_VALUE = std::numeric_limits<double>::quiet_NaN();
+	Vector<double> d1{NAN_VALUE, 1.0};
+	Vector<double> d2{NAN_VALUE, 2.0};
+	ASSERT_TRUE(d1<d2);
+}
+
+TEST(Comparison, onlyLessThan) {
+	struct OnlyLess {
+		int value;
+		bool operator<(const OnlyLess &other) const {
+			return value < other.value;
+		}
+	};
+	Vector<OnlyLess> v1{{1}, {2}};
+	Vector<OnlyLess> v2{{1}, {3}};
+	ASSERT_TRUE(v1<v2);
+	ASSERT_FALSE(v1>=v2);
+}
+
 TEST(Deletion, popBack) {
 	const size_t CREATE_COUNT = 10;
 
@@ -811,4 +1501,1286 @@ TEST(Deletion, clearWithCount) {
 	}
 	//Destruction of the vector shouldnt have changed anything
 	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
-}
\ No newline at end of file
+}
+
+TEST(SmallVector, staysInline) {
+	sandsnip3r::small_vector<int, 8> v;
+	const auto *objectBegin = reinterpret_cast<const char*>(&v);
+	const auto *objectEnd = objectBegin + sizeof(v);
+
+	ASSERT_EQ(v.capacity(), 8);
+	for (int i=0; i<8; ++i) {
+		v.push_back(i);
+	}
+	//The elements live inside the object itself
+	ASSERT_GE(reinterpret_cast<const char*>(v.data()), objectBegin);
+	ASSERT_LT(reinterpret_cast<const char*>(v.data()), objectEnd);
+	ASSERT_EQ(v.capacity(), 8);
+}
+
+TEST(SmallVector, growsOntoHeap) {
+	const int CREATE_COUNT = 100;
+	sandsnip3r::small_vector<int, 4> v;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(i);
+	}
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	ASSERT_GE(v.capacity(), CREATE_COUNT);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(v[i], i);
+	}
+
+	//Moves back inline once the elements fit again
+	v.resize(3);
+	v.shrink_to_fit();
+	ASSERT_EQ(v.capacity(), 4);
+	ASSERT_EQ(v, (sandsnip3r::small_vector<int, 4>{0, 1, 2}));
+}
+
+TEST(SmallVector, moveInlineWithCount) {
+	const size_t CREATE_COUNT = 3;
+	sandsnip3r::small_vector<TestObj, 4> v(CREATE_COUNT);
+
+	TestObj::resetCounts();
+	{
+		sandsnip3r::small_vector<TestObj, 4> newV(std::move(v));
+		ASSERT_EQ(newV.size(), CREATE_COUNT);
+	}
+	//Inline elements can't change owners, so they are moved one by one
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::moveConstruction, CREATE_COUNT);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
+}
+
+TEST(SmallVector, moveHeapWithCount) {
+	const size_t CREATE_COUNT = 10;
+	sandsnip3r::small_vector<TestObj, 4> v(CREATE_COUNT);
+
+	TestObj::resetCounts();
+	{
+		sandsnip3r::small_vector<TestObj, 4> newV(std::move(v));
+		ASSERT_EQ(newV.size(), CREATE_COUNT);
+		//The moved-from vector goes back to its inline storage
+		ASSERT_TRUE(v.empty());
+		ASSERT_EQ(v.capacity(), 4);
+	}
+	//The heap buffer changes owners
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::moveConstruction, 0);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
+}
+
+TEST(SmallVector, moveAssignInlineWithCount) {
+	const size_t CREATE_COUNT = 3;
+	sandsnip3r::small_vector<TestObj, 4> v(CREATE_COUNT);
+	sandsnip3r::small_vector<TestObj, 4> heap(CREATE_COUNT * 4);
+
+	TestObj::resetCounts();
+	heap = std::move(v);
+	ASSERT_EQ(heap.size(), CREATE_COUNT);
+	//Our heap buffer is kept and the inline elements are moved into it
+	ASSERT_GE(heap.capacity(), CREATE_COUNT * 4);
+	ASSERT_EQ(TestObj::moveConstruction, CREATE_COUNT);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT * 4);
+}
+
+TEST(SmallVector, swapInlineAndHeap) {
+	sandsnip3r::small_vector<int, 4> v1{1, 2};
+	sandsnip3r::small_vector<int, 4> v2{1, 2, 3, 4, 5, 6};
+
+	v1.swap(v2);
+	ASSERT_EQ(v1, (sandsnip3r::small_vector<int, 4>{1, 2, 3, 4, 5, 6}));
+	ASSERT_EQ(v2, (sandsnip3r::small_vector<int, 4>{1, 2}));
+	ASSERT_EQ(v2.capacity(), 4);
+}
+
+TEST(Deletion, eraseSingle) {
+	Vector<std::string> v{"a", "b", "c", "d"};
+	auto it = v.erase(v.begin() + 1);
+	ASSERT_EQ(*it, "c");
+	ASSERT_EQ(v, (Vector<std::string>{"a", "c", "d"}));
+	it = v.erase(v.end() - 1);
+	ASSERT_EQ(it, v.end());
+	ASSERT_EQ(v, (Vector<std::string>{"a", "c"}));
+}
+
+TEST(Deletion, eraseRange) {
+	Vector<int> v{0, 1, 2, 3, 4, 5};
+	auto it = v.erase(v.begin() + 1, v.begin() + 4);
+	ASSERT_EQ(*it, 4);
+	ASSERT_EQ(v, (Vector<int>{0, 4, 5}));
+	it = v.erase(v.begin(), v.begin());
+	ASSERT_EQ(it, v.begin());
+	ASSERT_EQ(v.size(), 3);
+	v.erase(v.begin(), v.end());
+	ASSERT_TRUE(v.empty());
+}
+
+TEST(Deletion, eraseRangeWithCount) {
+	const size_t CREATE_COUNT = 10;
+	Vector<TestObj> v(CREATE_COUNT);
+
+	TestObj::resetCounts();
+	v.erase(v.begin() + 2, v.begin() + 5);
+	//The 5 elements after the erased range are moved down, then the last 3 are destroyed
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::moveConstruction, 0);
+	ASSERT_EQ(TestObj::moveAssignment, 5);
+	ASSERT_EQ(TestObj::destruction, 3);
+	ASSERT_EQ(v.size(), CREATE_COUNT - 3);
+}
+
+TEST(Deletion, eraseIf) {
+	const int CREATE_COUNT = 1000;
+	sandsnip3r::vector<int> v;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(i);
+	}
+	const auto capacity = v.capacity();
+
+	auto erased = sandsnip3r::erase_if(v, [](int i) {
+		return i % 3 != 0;
+	});
+	ASSERT_EQ(erased, CREATE_COUNT - 334);
+	ASSERT_EQ(v.size(), 334);
+	ASSERT_EQ(v.capacity(), capacity);
+	for (size_t i=0; i<v.size(); ++i) {
+		ASSERT_EQ(v[i], i*3);
+	}
+
+	ASSERT_EQ(sandsnip3r::erase(v, 3), 1);
+	ASSERT_EQ(v[1], 6);
+}
+
+TEST(Deletion, eraseUnordered) {
+	sandsnip3r::vector<std::string> v{"a", "b", "c", "d"};
+	auto it = v.erase_unordered(v.begin());
+	ASSERT_EQ(*it, "d");
+	ASSERT_EQ(v, (sandsnip3r::vector<std::string>{"d", "b", "c"}));
+	v.erase_unordered(v.end() - 1);
+	ASSERT_EQ(v, (sandsnip3r::vector<std::string>{"d", "b"}));
+
+	sandsnip3r::vector<int> ints{1, 2, 3, 4};
+	ints.erase_unordered(ints.begin() + 1);
+	ASSERT_EQ(ints, (sandsnip3r::vector<int>{1, 4, 3}));
+}
+
+#ifdef SANDSNIP3R_VECTOR_STATS
+TEST(Stats, reallocations) {
+	const size_t CREATE_COUNT = 100;
+	sandsnip3r::reset_global_vector_stats();
+
+	sandsnip3r::vector<int> v;
+	v.reserve(CREATE_COUNT);
+	for (size_t i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(i);
+	}
+	//Only the reserve allocated, and it had nothing to move
+	ASSERT_EQ(v.stats().reallocations, 1);
+	ASSERT_EQ(v.stats().elements_moved, 0);
+	ASSERT_EQ(v.stats().peak_capacity_bytes, CREATE_COUNT * sizeof(int));
+
+	v.push_back(0);
+	ASSERT_EQ(v.stats().reallocations, 2);
+	ASSERT_EQ(v.stats().elements_moved, CREATE_COUNT);
+	ASSERT_EQ(v.stats().bytes_moved, CREATE_COUNT * sizeof(int));
+	ASSERT_EQ(v.stats().peak_capacity_bytes, v.capacity() * sizeof(int));
+
+	const auto global = sandsnip3r::global_vector_stats();
+	ASSERT_EQ(global.reallocations, 2);
+	ASSERT_EQ(global.elements_moved, CREATE_COUNT);
+}
+
+TEST(Stats, waste) {
+	const size_t CREATE_COUNT = 10;
+	const size_t RESERVE_AMOUNT = 100;
+
+	sandsnip3r::vector<int> v(CREATE_COUNT);
+	v.reserve(RESERVE_AMOUNT);
+	v.shrink_to_fit();
+	ASSERT_EQ(v.stats().wasted_bytes, 0);
+	v.clear();
+	ASSERT_EQ(v.stats().wasted_bytes, CREATE_COUNT * sizeof(int));
+}
+
+TEST(Stats, smallVectorDestructionIsNotWaste) {
+	sandsnip3r::reset_global_vector_stats();
+	{
+		sandsnip3r::small_vector<int, 8> v(4);
+	}
+	ASSERT_EQ(sandsnip3r::global_vector_stats().wasted_bytes, 0);
+}
+#endif //SANDSNIP3R_VECTOR_STATS
+
+TEST(Arena, lastVectorGrowsInPlace) {
+	const int CREATE_COUNT = 1000;
+	sandsnip3r::arena arena;
+	sandsnip3r::vector<int, sandsnip3r::arena_allocator<int>> v{sandsnip3r::arena_allocator<int>(arena)};
+
+	v.push_back(0);
+	const int *firstBuffer = v.data();
+	for (int i=1; i<CREATE_COUNT; ++i) {
+		v.push_back(i);
+	}
+	//Every growth extended the same allocation
+	ASSERT_EQ(v.data(), firstBuffer);
+	ASSERT_GT(v.capacity(), 1);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(v[i], i);
+	}
+}
+
+TEST(Arena, interleavedVectorsWithCount) {
+	const size_t CREATE_COUNT = 100;
+	sandsnip3r::arena arena;
+	sandsnip3r::arena_allocator<TestObj> allocator(arena);
+
+	TestObj::resetCounts();
+	{
+		sandsnip3r::vector<TestObj, sandsnip3r::arena_allocator<TestObj>> v1(allocator);
+		sandsnip3r::vector<TestObj, sandsnip3r::arena_allocator<TestObj>> v2(allocator);
+		for (size_t i=0; i<CREATE_COUNT; ++i) {
+			v1.emplace_back();
+			v2.emplace_back();
+		}
+		ASSERT_EQ(v1.size(), CREATE_COUNT);
+		ASSERT_EQ(v2.size(), CREATE_COUNT);
+		//Only whichever vector was allocated last could grow in place, the other has to move
+		ASSERT_GT(TestObj::moveConstruction, 0);
+	}
+	ASSERT_EQ(TestObj::destruction, TestObj::defaultConstruction + TestObj::moveConstruction);
+	arena.release();
+}
+
+TEST(CompactVector, layout) {
+	ASSERT_EQ(sizeof(sandsnip3r::compact_vector<int>), 16);
+	ASSERT_EQ(sizeof(sandsnip3r::compact_vector<std::string>), 16);
+}
+
+TEST(CompactVector, basicOperations) {
+	const int CREATE_COUNT = 1000;
+	sandsnip3r::compact_vector<std::string> v;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(std::to_string(i));
+	}
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	ASSERT_EQ(v[500], "500");
+
+	v.insert(v.begin(), {"a", "b"});
+	v.emplace(v.begin() + 1, "c");
+	ASSERT_EQ(v[0], "a");
+	ASSERT_EQ(v[1], "c");
+	ASSERT_EQ(v[2], "b");
+	ASSERT_EQ(v[3], "0");
+
+	v.erase(v.begin(), v.begin() + 3);
+	ASSERT_EQ(v.front(), "0");
+	ASSERT_EQ(sandsnip3r::erase(v, std::string("10")), 1);
+	ASSERT_EQ(v.size(), CREATE_COUNT - 1);
+
+	sandsnip3r::compact_vector<std::string> copy(v);
+	ASSERT_TRUE(copy == v);
+	copy.back() = "z";
+	ASSERT_TRUE(v < copy);
+
+	sandsnip3r::compact_vector<std::string> moved(std::move(copy));
+	ASSERT_TRUE(copy.empty());
+	ASSERT_EQ(moved.back(), "z");
+
+	moved.resize(3);
+	moved.shrink_to_fit();
+	ASSERT_EQ(moved.capacity(), 3);
+	ASSERT_EQ(moved, (sandsnip3r::compact_vector<std::string>{"0", "1", "2"}));
+}
+
+TEST(CompactVector, assignmentReusesElements) {
+	const size_t CREATE_COUNT = 10;
+	sandsnip3r::compact_vector<TestObj> source(CREATE_COUNT);
+	sandsnip3r::compact_vector<TestObj> v(CREATE_COUNT);
+
+	TestObj::resetCounts();
+	v = source;
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::copyAssignment, CREATE_COUNT);
+	ASSERT_EQ(TestObj::destruction, 0);
+
+	sandsnip3r::compact_vector<TestObj> smaller(CREATE_COUNT / 2);
+	TestObj::resetCounts();
+	v = smaller;
+	ASSERT_EQ(TestObj::copyAssignment, CREATE_COUNT / 2);
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT / 2);
+
+	sandsnip3r::compact_vector<std::string> strings{"1", "2", "3", "4"};
+	strings.assign(2, "a");
+	ASSERT_EQ(strings, (sandsnip3r::compact_vector<std::string>{"a", "a"}));
+	strings.assign({"b", "c", "d"});
+	ASSERT_EQ(strings, (sandsnip3r::compact_vector<std::string>{"b", "c", "d"}));
+	ASSERT_EQ(strings.capacity(), 4);
+	strings.assign(8, strings[0]);
+	ASSERT_EQ(strings.size(), 8);
+	ASSERT_EQ(strings.back(), "b");
+
+	sandsnip3r::compact_vector<int> ints;
+	ints.append_n(5, [](uint32_t i) {
+		return static_cast<int>(i * i);
+	});
+	ASSERT_EQ(ints, (sandsnip3r::compact_vector<int>{0, 1, 4, 9, 16}));
+	ints.reserve(6);
+	ints.push_back_unchecked(25);
+	ints.append_range(sandsnip3r::compact_vector<int>{36});
+	ASSERT_EQ(ints.back(), 36);
+	ASSERT_EQ(ints[5], 25);
+}
+
+TEST(CompactVector, growthWithCount) {
+	const size_t CREATE_COUNT = 100;
+
+	TestObj::resetCounts();
+	{
+		sandsnip3r::compact_vector<TestObj> v;
+		for (size_t i=0; i<CREATE_COUNT; ++i) {
+			v.emplace_back();
+		}
+		ASSERT_EQ(TestObj::copyConstruction, 0);
+	}
+	ASSERT_EQ(TestObj::defaultConstruction, CREATE_COUNT);
+	ASSERT_EQ(TestObj::destruction, TestObj::defaultConstruction + TestObj::moveConstruction);
+}
+
+TEST(CompactVector, failedGrowthChangesNothing) {
+	const int CREATE_COUNT = 100;
+	using Vector = sandsnip3r::compact_vector<ThrowingMoveObj, CountingAllocator<ThrowingMoveObj>>;
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	AllocationCounts::resetCounts();
+	{
+		Vector v;
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			v.emplace_back(i);
+		}
+		v.shrink_to_fit();
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(v.reserve(CREATE_COUNT * 2), std::runtime_error);
+		ASSERT_EQ(v.capacity(), CREATE_COUNT);
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(v.insert(v.begin() + 1, ThrowingMoveObj(-1)), std::runtime_error);
+		ASSERT_EQ(v.size(), CREATE_COUNT);
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			ASSERT_EQ(v[i].value, i);
+		}
+
+		//Constructors release their buffer when an element can't be made
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(Vector copy(v), std::runtime_error);
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(Vector filled(CREATE_COUNT, ThrowingMoveObj(1)), std::runtime_error);
+		ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	}
+	ASSERT_EQ(AllocationCounts::allocations, AllocationCounts::deallocations);
+
+	//Sizes beyond 32 bits are rejected instead of wrapping
+	sandsnip3r::compact_vector<char> chars;
+	const std::size_t tooMany = std::size_t(std::numeric_limits<std::uint32_t>::max()) + 2;
+	ASSERT_THROW(chars.reserve(tooMany), std::length_error);
+	ASSERT_THROW(chars.resize(tooMany), std::length_error);
+	ASSERT_THROW(sandsnip3r::compact_vector<char>(tooMany, 'a'), std::length_error);
+	ASSERT_EQ(chars.capacity(), 0);
+}
+
+#ifdef __linux__
+struct MappedRecord {
+	int id;
+	double weight;
+};
+
+TEST(MappedVector, reopen) {
+	const std::string path = testing::TempDir() + "mapped_vector_reopen";
+	std::remove(path.c_str());
+	const int CREATE_COUNT = 10000;
+	{
+		sandsnip3r::mapped_vector<MappedRecord> v(path);
+		ASSERT_TRUE(v.empty());
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			v.push_back({i, i * 0.5});
+		}
+		v.shrink_to_fit();
+	}
+	{
+		sandsnip3r::mapped_vector<MappedRecord> v(path);
+		ASSERT_EQ(v.size(), CREATE_COUNT);
+		ASSERT_EQ(v.capacity(), CREATE_COUNT);
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			ASSERT_EQ(v[i].id, i);
+			ASSERT_EQ(v[i].weight, i * 0.5);
+		}
+		v.resize(2);
+	}
+	sandsnip3r::mapped_vector<MappedRecord> v(path);
+	ASSERT_EQ(v.size(), 2);
+	ASSERT_EQ(v.back().id, 1);
+	std::remove(path.c_str());
+}
+
+TEST(MappedVector, readOnly) {
+	const std::string path = testing::TempDir() + "mapped_vector_read_only";
+	std::remove(path.c_str());
+	ASSERT_THROW(sandsnip3r::mapped_vector_view<int>{path}, std::system_error);
+
+	sandsnip3r::mapped_vector<int> writer(path);
+	writer.push_back(1);
+	writer.push_back(2);
+
+	//The view only hands out const access to its PROT_READ pages
+	sandsnip3r::mapped_vector_view<int> reader(path);
+	static_assert(std::is_same<decltype(reader[0]), const int&>::value, "");
+	static_assert(std::is_same<decltype(reader.begin()), const int*>::value, "");
+	ASSERT_EQ(reader.size(), 2);
+	ASSERT_EQ(reader[1], 2);
+	writer[1] = 3;
+	ASSERT_EQ(reader[1], 3);
+	ASSERT_EQ(*(reader.end() - 1), 3);
+
+	ASSERT_THROW(sandsnip3r::mapped_vector<double>{path}, std::runtime_error);
+	std::remove(path.c_str());
+}
+
+TEST(MappedVector, movedFrom) {
+	const std::string path = testing::TempDir() + "mapped_vector_moved_from";
+	std::remove(path.c_str());
+	sandsnip3r::mapped_vector<int> v(path);
+	v.push_back(1);
+	sandsnip3r::mapped_vector<int> movedTo(std::move(v));
+	ASSERT_EQ(movedTo.size(), 1);
+	//A moved-from vector has no mapping, but still reports itself as empty
+	ASSERT_EQ(v.size(), 0);
+	ASSERT_EQ(v.capacity(), 0);
+	ASSERT_TRUE(v.empty());
+	std::remove(path.c_str());
+}
+#endif //__linux__
+
+#ifdef SANDSNIP3R_VECTOR_PARALLEL
+//Counts live objects from any thread, and throws from the copy constructor once copiesUntilThrow
+//	reaches zero
+class ParallelObj {
+public:
+	ParallelObj(int num = 0) : value(num) {
+		++alive;
+	}
+	ParallelObj(const ParallelObj &other) : value(other.value) {
+		if (copiesUntilThrow.fetch_sub(1) == 0) {
+			throw std::runtime_error("ParallelObj copy failed");
+		}
+		++alive;
+	}
+	~ParallelObj() {
+		--alive;
+	}
+	int value;
+	static std::atomic<int64_t> alive;
+	static std::atomic<int64_t> copiesUntilThrow;
+};
+
+std::atomic<int64_t> ParallelObj::alive;
+std::atomic<int64_t> ParallelObj::copiesUntilThrow;
+
+class Parallel : public ::testing::Test {
+protected:
+	void SetUp() override {
+		previousThreshold = sandsnip3r::parallel_threshold();
+		sandsnip3r::set_parallel_threshold(64);
+		ParallelObj::copiesUntilThrow = std::numeric_limits<int64_t>::max();
+	}
+	void TearDown() override {
+		sandsnip3r::set_parallel_threshold(previousThreshold);
+	}
+	std::size_t previousThreshold;
+};
+
+TEST_F(Parallel, fillAndCopy) {
+	const int CREATE_COUNT = 100000;
+	{
+		sandsnip3r::vector<ParallelObj> v(CREATE_COUNT, ParallelObj(7));
+		sandsnip3r::vector<ParallelObj> copy(v);
+		copy.resize(CREATE_COUNT * 2, ParallelObj(8));
+		ASSERT_EQ(ParallelObj::alive, CREATE_COUNT * 3);
+		for (int i=0; i<CREATE_COUNT * 2; ++i) {
+			ASSERT_EQ(copy[i].value, (i < CREATE_COUNT ? 7 : 8));
+		}
+		v = copy;
+		ASSERT_EQ(v.size(), CREATE_COUNT * 2);
+		ASSERT_EQ(v.back().value, 8);
+
+		sandsnip3r::vector<std::string> strings(CREATE_COUNT);
+		strings.resize(CREATE_COUNT * 2);
+		for (int i=0; i<CREATE_COUNT * 2; ++i) {
+			ASSERT_TRUE(strings[i].empty());
+		}
+	}
+	ASSERT_EQ(ParallelObj::alive, 0);
+}
+
+TEST_F(Parallel, relocate) {
+	const int CREATE_COUNT = 100000;
+	sandsnip3r::vector<std::string> strings;
+	sandsnip3r::vector<int> ints;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		strings.push_back(std::to_string(i));
+		ints.push_back(i);
+	}
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(strings[i], std::to_string(i));
+		ASSERT_EQ(ints[i], i);
+	}
+}
+
+TEST_F(Parallel, exceptionCleansUp) {
+	const int CREATE_COUNT = 100000;
+	{
+		sandsnip3r::vector<ParallelObj> v(CREATE_COUNT);
+		ParallelObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(sandsnip3r::vector<ParallelObj> copy(v), std::runtime_error);
+		ASSERT_EQ(ParallelObj::alive, CREATE_COUNT);
+
+		v.reserve(CREATE_COUNT * 2);
+		ParallelObj::copiesUntilThrow = CREATE_COUNT / 3;
+		ASSERT_THROW(v.resize(CREATE_COUNT * 2, ParallelObj(1)), std::runtime_error);
+		//The vector keeps its old elements
+		ASSERT_EQ(v.size(), CREATE_COUNT);
+		ASSERT_EQ(ParallelObj::alive, CREATE_COUNT);
+	}
+	ASSERT_EQ(ParallelObj::alive, 0);
+}
+#endif //SANDSNIP3R_VECTOR_PARALLEL
+
+TEST(ConcurrentVector, segmentLayout) {
+	using segments = sandsnip3r::detail::geometric_segments<8>;
+	ASSERT_EQ(segments::segmentOf(0), 0);
+	ASSERT_EQ(segments::segmentOf(7), 0);
+	ASSERT_EQ(segments::segmentOf(8), 1);
+	ASSERT_EQ(segments::segmentOf(23), 1);
+	ASSERT_EQ(segments::segmentOf(24), 2);
+	ASSERT_EQ(segments::segmentBegin(2), 24);
+	ASSERT_EQ(segments::offsetInSegment(30, 2), 6);
+	ASSERT_EQ(segments::SEGMENT_COUNT, std::numeric_limits<std::size_t>::digits - 3);
+}
+
+TEST(ConcurrentVector, concurrentPushBack) {
+	const int THREAD_COUNT = 8;
+	const int PER_THREAD_COUNT = 20000;
+	sandsnip3r::concurrent_vector<int> v;
+	v.push_back(-1);
+	const int *first = &v[0];
+	std::vector<std::thread> threads;
+	for (int t=0; t<THREAD_COUNT; ++t) {
+		threads.emplace_back([&v, t]() {
+			for (int i=0; i<PER_THREAD_COUNT; ++i) {
+				auto it = v.push_back(t * PER_THREAD_COUNT + i);
+				//Readable right away, no matter what the other threads are doing
+				ASSERT_EQ(*it, t * PER_THREAD_COUNT + i);
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	//Growth never moved existing elements
+	ASSERT_EQ(&v[0], first);
+	ASSERT_EQ(v.size(), THREAD_COUNT * PER_THREAD_COUNT + 1);
+	ASSERT_GE(v.capacity(), v.size());
+
+	std::vector<bool> seen(THREAD_COUNT * PER_THREAD_COUNT);
+	for (auto it=std::next(v.begin()); it!=v.end(); ++it) {
+		ASSERT_FALSE(seen[*it]);
+		seen[*it] = true;
+	}
+}
+
+TEST(ConcurrentVector, freeze) {
+	const int CREATE_COUNT = 1000;
+	sandsnip3r::concurrent_vector<std::string> strings;
+	sandsnip3r::concurrent_vector<int> ints;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		strings.emplace_back(std::to_string(i));
+		ints.push_back(i);
+	}
+	sandsnip3r::vector<std::string> frozenStrings = strings.freeze();
+	sandsnip3r::vector<int> frozenInts = ints.freeze();
+	ASSERT_TRUE(strings.empty());
+	ASSERT_TRUE(ints.empty());
+	ASSERT_EQ(frozenStrings.size(), CREATE_COUNT);
+	ASSERT_EQ(frozenInts.size(), CREATE_COUNT);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(frozenStrings[i], std::to_string(i));
+		ASSERT_EQ(frozenInts[i], i);
+	}
+}
+
+TEST(ConcurrentVector, failedSegmentAllocation) {
+	const int FIRST_SEGMENT_SIZE = 8;
+	AllocationCounts::resetCounts();
+	{
+		sandsnip3r::concurrent_vector<std::string, CountingAllocator<std::string>, FIRST_SEGMENT_SIZE> v;
+		for (int i=0; i<FIRST_SEGMENT_SIZE; ++i) {
+			v.push_back(std::to_string(i));
+		}
+		//The next element needs a new segment, which can't be allocated
+		AllocationCounts::allocationsUntilThrow = 0;
+		ASSERT_THROW(v.emplace_back("lost"), std::bad_alloc);
+		ASSERT_EQ(v.size(), FIRST_SEGMENT_SIZE);
+		ASSERT_EQ(v.capacity(), FIRST_SEGMENT_SIZE);
+
+		AllocationCounts::allocationsUntilThrow = std::numeric_limits<int64_t>::max();
+		v.emplace_back("next");
+		ASSERT_EQ(v.size(), FIRST_SEGMENT_SIZE + 1);
+		ASSERT_EQ(v.back(), "next");
+		for (int i=0; i<FIRST_SEGMENT_SIZE; ++i) {
+			ASSERT_EQ(v[i], std::to_string(i));
+		}
+	}
+	ASSERT_EQ(AllocationCounts::allocations, AllocationCounts::deallocations);
+}
+
+//Has no default constructor, and refuses to be constructed from a negative number
+struct RejectsNegative {
+	explicit RejectsNegative(int number) : text(std::to_string(number)) {
+		if (number < 0) {
+			throw std::invalid_argument("negative");
+		}
+	}
+	std::string text;
+};
+
+TEST(ConcurrentVector, failedConstruction) {
+	sandsnip3r::concurrent_vector<RejectsNegative> v;
+	v.emplace_back(0);
+	ASSERT_THROW(v.emplace_back(-1), std::invalid_argument);
+	v.emplace_back(2);
+	ASSERT_THROW(v.emplace_back(-3), std::invalid_argument);
+	//The slots stay claimed but hold nothing
+	ASSERT_EQ(v.size(), 4);
+	ASSERT_TRUE(v.has_element(0));
+	ASSERT_FALSE(v.has_element(1));
+	ASSERT_THROW(v.at(1), std::out_of_range);
+	ASSERT_EQ(v.at(2).text, "2");
+	ASSERT_EQ(v.back().text, "2");
+	std::vector<std::string> iterated;
+	for (const auto &element : v) {
+		iterated.push_back(element.text);
+	}
+	ASSERT_EQ(iterated, (std::vector<std::string>{"0", "2"}));
+
+	sandsnip3r::vector<RejectsNegative> frozen = v.freeze();
+	ASSERT_EQ(frozen.size(), 2);
+	ASSERT_EQ(frozen[0].text, "0");
+	ASSERT_EQ(frozen[1].text, "2");
+	ASSERT_TRUE(v.empty());
+}
+
+TEST(ConcurrentVector, readersOnlySeeFinishedElements) {
+	const int THREAD_COUNT = 4;
+	const int PER_THREAD_COUNT = 20000;
+	sandsnip3r::concurrent_vector<std::string> v;
+	std::atomic<bool> done{false};
+	std::thread reader([&]() {
+		while (!done) {
+			const size_t size = v.size();
+			//Every slot below size() is fully constructed
+			for (size_t i=0; i<size; ++i) {
+				ASSERT_EQ(v[i].size(), 32);
+			}
+		}
+	});
+	std::vector<std::thread> writers;
+	for (int t=0; t<THREAD_COUNT; ++t) {
+		writers.emplace_back([&v]() {
+			for (int i=0; i<PER_THREAD_COUNT; ++i) {
+				v.emplace_back(32, 'x');
+			}
+		});
+	}
+	for (auto &writer : writers) {
+		writer.join();
+	}
+	done = true;
+	reader.join();
+	ASSERT_EQ(v.size(), THREAD_COUNT * PER_THREAD_COUNT);
+}
+
+TEST(SegmentedVector, referencesStayValid) {
+	const int CREATE_COUNT = 100000;
+	sandsnip3r::segmented_vector<std::string> v;
+	v.push_back("first");
+	const std::string *first = &v.front();
+	for (int i=1; i<CREATE_COUNT; ++i) {
+		//Appending a copy of an element is safe, nothing moves
+		v.push_back(v.back());
+	}
+	ASSERT_EQ(&v.front(), first);
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	ASSERT_EQ(v.back(), "first");
+	ASSERT_GE(v.capacity(), v.size());
+	ASSERT_LT(v.capacity(), 2 * v.size() + 8);
+
+	TestObj::resetCounts();
+	{
+		sandsnip3r::segmented_vector<TestObj> objects;
+		for (int i=0; i<CREATE_COUNT; ++i) {
+			objects.emplace_back();
+		}
+		//Growth never moves or copies
+		ASSERT_EQ(TestObj::moveConstruction, 0);
+		ASSERT_EQ(TestObj::copyConstruction, 0);
+	}
+	ASSERT_EQ(TestObj::destruction, CREATE_COUNT);
+}
+
+TEST(SegmentedVector, vectorInterface) {
+	sandsnip3r::segmented_vector<int> v{5, 3, 1};
+	for (int i=0; i<100; ++i) {
+		v.insert(v.begin() + 1, i);
+	}
+	ASSERT_EQ(v.size(), 103);
+	ASSERT_EQ(v[0], 5);
+	ASSERT_EQ(v[1], 99);
+	ASSERT_EQ(v.back(), 1);
+
+	std::sort(v.begin(), v.end());
+	ASSERT_TRUE(std::is_sorted(v.cbegin(), v.cend()));
+	ASSERT_EQ(sandsnip3r::erase_if(v, [](int value) { return value % 2 == 0; }), 50);
+	ASSERT_EQ(v.size(), 53);
+
+	sandsnip3r::segmented_vector<int> copy(v);
+	ASSERT_TRUE(copy == v);
+	copy.erase(copy.begin(), copy.begin() + 2);
+	ASSERT_TRUE(v < copy);
+	v = copy;
+	ASSERT_TRUE(v == copy);
+
+	v.resize(5);
+	v.shrink_to_fit();
+	ASSERT_EQ(v.capacity(), 8);
+	ASSERT_EQ(std::accumulate(v.rbegin(), v.rend(), 0), 3 + 3 + 5 + 5 + 7);
+
+	sandsnip3r::segmented_vector<int> moved(std::move(copy));
+	ASSERT_TRUE(copy.empty());
+	ASSERT_EQ(moved.size(), 51);
+	ASSERT_THROW(moved.at(51), std::out_of_range);
+}
+
+TEST(SegmentedVector, failedConstructionReleasesSegments) {
+	const int CREATE_COUNT = 100;
+	using Vector = sandsnip3r::segmented_vector<ThrowingMoveObj, CountingAllocator<ThrowingMoveObj>>;
+	AllocationCounts::resetCounts();
+	{
+		ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+		Vector v(CREATE_COUNT, ThrowingMoveObj(1));
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(Vector copy(v), std::runtime_error);
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(Vector filled(CREATE_COUNT, ThrowingMoveObj(1)), std::runtime_error);
+		ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+		ASSERT_THROW(Vector ranged(v.begin(), v.end()), std::runtime_error);
+		ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	}
+	ASSERT_EQ(AllocationCounts::allocations, AllocationCounts::deallocations);
+}
+
+TEST(IncrementalVector, boundedWorkPerPushBack) {
+	const size_t CREATE_COUNT = 100000;
+	const size_t MIGRATION_STEP = 16;
+	TestObj::resetCounts();
+	{
+		sandsnip3r::incremental_vector<TestObj, std::allocator<TestObj>, sandsnip3r::golden_ratio_growth, MIGRATION_STEP> v;
+		bool sawMigration = false;
+		for (size_t i=0; i<CREATE_COUNT; ++i) {
+			const auto movesBefore = TestObj::moveConstruction;
+			v.emplace_back();
+			ASSERT_LE(TestObj::moveConstruction - movesBefore, MIGRATION_STEP);
+			sawMigration = sawMigration || v.migrating();
+		}
+		ASSERT_TRUE(sawMigration);
+		ASSERT_EQ(v.size(), CREATE_COUNT);
+		ASSERT_EQ(TestObj::copyConstruction, 0);
+	}
+	ASSERT_EQ(TestObj::destruction, TestObj::defaultConstruction + TestObj::moveConstruction);
+}
+
+TEST(IncrementalVector, indexingDuringMigration) {
+	const int CREATE_COUNT = 1000;
+	sandsnip3r::incremental_vector<std::string, std::allocator<std::string>, sandsnip3r::golden_ratio_growth, 1> v;
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(std::to_string(i));
+		if (v.migrating()) {
+			//Both buffers are in use, every element is still where indexing expects it
+			for (int j=0; j<=i; ++j) {
+				ASSERT_EQ(v[j], std::to_string(j));
+			}
+		}
+	}
+	while (!v.migrating()) {
+		v.push_back(v.back());
+	}
+	//Popping back into the part that hasn't moved yet
+	const auto migratingSize = v.size();
+	while (v.migrating()) {
+		v.pop_back();
+	}
+	ASSERT_LT(v.size(), migratingSize);
+	for (size_t i=0; i<std::min<size_t>(v.size(), CREATE_COUNT); ++i) {
+		ASSERT_EQ(v[i], std::to_string(i));
+	}
+
+	sandsnip3r::incremental_vector<std::string> copy(v.begin(), v.end());
+	ASSERT_TRUE(std::equal(copy.begin(), copy.end(), v.data()));
+	ASSERT_FALSE(v.migrating());
+}
+
+TEST(IncrementalVector, allocatorsAndFailedConstruction) {
+	const int CREATE_COUNT = 100;
+	using Vector = sandsnip3r::incremental_vector<std::string, CountingAllocator<std::string>>;
+	static_assert(std::is_nothrow_move_assignable<sandsnip3r::incremental_vector<std::string>>::value, "");
+	static_assert(!std::is_nothrow_move_assignable<Vector>::value, "");
+	AllocationCounts::resetCounts();
+	{
+		Vector first(CREATE_COUNT, "a", CountingAllocator<std::string>(1));
+		Vector second(CREATE_COUNT / 2, "b", CountingAllocator<std::string>(2));
+		//Allocators don't propagate, so the elements are moved into our own buffer
+		first = std::move(second);
+		ASSERT_EQ(first.get_allocator().id, 1);
+		ASSERT_EQ(first.size(), CREATE_COUNT / 2);
+		ASSERT_EQ(first.back(), "b");
+		Vector third(3, "c", CountingAllocator<std::string>(3));
+		first = third;
+		ASSERT_EQ(first.get_allocator().id, 1);
+		ASSERT_EQ(first.size(), 3);
+	}
+	ASSERT_EQ(AllocationCounts::allocations, AllocationCounts::deallocations);
+
+	//Constructors release their buffer when an element can't be made
+	using ThrowingVector = sandsnip3r::incremental_vector<ThrowingMoveObj, CountingAllocator<ThrowingMoveObj>>;
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	ThrowingVector v(CREATE_COUNT);
+	AllocationCounts::resetCounts();
+	ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+	ASSERT_THROW(ThrowingVector copy(v), std::runtime_error);
+	ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+	ASSERT_THROW(ThrowingVector filled(CREATE_COUNT, ThrowingMoveObj(1)), std::runtime_error);
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	ASSERT_EQ(AllocationCounts::allocations, AllocationCounts::deallocations);
+}
+
+TEST(IncrementalVector, throwingMigrationIsDeferred) {
+	sandsnip3r::incremental_vector<ThrowingMoveObj> v;
+	//Until there is room for one more element while old ones still wait to be migrated
+	while (!v.migrating() || v.size() == v.capacity()) {
+		v.push_back(ThrowingMoveObj(static_cast<int>(v.size())));
+	}
+	//Migrating would copy, every copy throws from here on
+	ThrowingMoveObj::copiesUntilThrow = 0;
+	const size_t migratingSize = v.size();
+	v.push_back(ThrowingMoveObj(static_cast<int>(migratingSize)));
+	ASSERT_EQ(v.size(), migratingSize + 1);
+	v.pop_back();
+	ASSERT_TRUE(v.migrating());
+	//Finishing the migration is where a copy can fail, and it leaves every element in place
+	ASSERT_THROW(v.finish_migration(), std::runtime_error);
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	v.finish_migration();
+	ASSERT_FALSE(v.migrating());
+	ASSERT_EQ(v.size(), migratingSize);
+	for (size_t i=0; i<v.size(); ++i) {
+		ASSERT_EQ(v[i].value, static_cast<int>(i));
+	}
+}
+
+TEST(SnapshotVector, snapshotsAreImmutable) {
+	sandsnip3r::snapshot_vector<std::string> v;
+	v.push_back("a");
+	v.push_back("b");
+	{
+		auto before = v.take_snapshot();
+		v.replace(0, "c");
+		v.push_back("d");
+		for (int i=0; i<100; ++i) {
+			v.push_back("e");
+		}
+		//The snapshot still sees the buffer it started with, which can't be reclaimed yet
+		ASSERT_EQ(before.size(), 2);
+		ASSERT_EQ(before[0], "a");
+		ASSERT_EQ(before[1], "b");
+		ASSERT_GT(v.retired_buffers(), 0);
+
+		auto after = v.take_snapshot();
+		ASSERT_EQ(after.size(), 103);
+		ASSERT_EQ(after[0], "c");
+		ASSERT_EQ(after[2], "d");
+	}
+	v.reclaim();
+	ASSERT_EQ(v.retired_buffers(), 0);
+	v.pop_back();
+	v.clear();
+	ASSERT_TRUE(v.take_snapshot().empty());
+}
+
+TEST(SnapshotVector, growthPolicy) {
+	sandsnip3r::snapshot_vector<int, std::allocator<int>, sandsnip3r::doubling_growth> v;
+	for (int i=0; i<9; ++i) {
+		v.push_back(i);
+	}
+	ASSERT_EQ(v.capacity(), 16);
+	for (int i=0; i<9; ++i) {
+		ASSERT_EQ(v[i], i);
+	}
+}
+
+TEST(SnapshotVector, concurrentReaders) {
+	const int READER_COUNT = 4;
+	const int CREATE_COUNT = 20000;
+	sandsnip3r::snapshot_vector<int> v;
+	std::atomic<bool> done{false};
+	std::vector<std::thread> readers;
+	for (int r=0; r<READER_COUNT; ++r) {
+		readers.emplace_back([&]() {
+			size_t lastSize = 0;
+			while (!done) {
+				auto snapshot = v.take_snapshot();
+				//The writer only ever grows the table and rewrites entries with the same value
+				ASSERT_GE(snapshot.size(), lastSize);
+				lastSize = snapshot.size();
+				for (size_t i=0; i<snapshot.size(); ++i) {
+					ASSERT_EQ(snapshot[i], static_cast<int>(i));
+				}
+			}
+		});
+	}
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.push_back(i);
+		if (i % 1000 == 0) {
+			v.replace(i / 2, i / 2);
+		}
+	}
+	done = true;
+	for (auto &reader : readers) {
+		reader.join();
+	}
+	v.reclaim();
+	ASSERT_EQ(v.retired_buffers(), 0);
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+}
+
+TEST(Move, noexceptTraits) {
+	using Vector = sandsnip3r::vector<TestObj>;
+	static_assert(std::is_nothrow_move_constructible<Vector>::value, "");
+	static_assert(std::is_nothrow_move_assignable<Vector>::value, "");
+	static_assert(std::is_nothrow_swappable<Vector>::value, "");
+	static_assert(std::is_nothrow_move_constructible<sandsnip3r::small_vector<int, 4>>::value, "");
+	static_assert(!std::is_nothrow_move_constructible<sandsnip3r::small_vector<ThrowingMoveObj, 4>>::value, "");
+	static_assert(std::is_nothrow_move_assignable<sandsnip3r::small_vector<int, 4>>::value, "");
+	static_assert(!std::is_nothrow_move_assignable<sandsnip3r::small_vector<ThrowingMoveObj, 4>>::value, "");
+	//Inline elements can't be handed to a vector, whose move constructor never moves elements
+	static_assert(!std::is_constructible<Vector, sandsnip3r::small_vector<TestObj, 4>&&>::value, "");
+	static_assert(!std::is_assignable<Vector&, sandsnip3r::small_vector<TestObj, 4>&&>::value, "");
+	static_assert(std::is_nothrow_move_assignable<sandsnip3r::compact_vector<int>>::value, "");
+}
+
+TEST(Move, nestedVectorsMoveOnGrowth) {
+	const size_t OUTER_COUNT = 1000;
+	const size_t INNER_COUNT = 10;
+	std::vector<sandsnip3r::vector<TestObj>> outer;
+	TestObj::resetCounts();
+	for (size_t i=0; i<OUTER_COUNT; ++i) {
+		outer.emplace_back(INNER_COUNT);
+	}
+	//The outer vector grew many times without copying a single inner element
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::moveConstruction, 0);
+
+	sandsnip3r::vector<sandsnip3r::vector<TestObj>> sandsnip3rOuter;
+	for (size_t i=0; i<OUTER_COUNT; ++i) {
+		sandsnip3rOuter.emplace_back(INNER_COUNT);
+	}
+	ASSERT_EQ(TestObj::copyConstruction, 0);
+	ASSERT_EQ(TestObj::moveConstruction, 0);
+}
+
+TEST(Move, growthCopiesWhenMoveMayThrow) {
+	const int CREATE_COUNT = 100;
+	ThrowingMoveObj::copies = 0;
+	ThrowingMoveObj::moves = 0;
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	sandsnip3r::vector<ThrowingMoveObj> v;
+	v.reserve(1);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		v.emplace_back(i);
+	}
+	ASSERT_EQ(ThrowingMoveObj::moves, 0);
+	ASSERT_GT(ThrowingMoveObj::copies, 0);
+
+	//A failed reallocation leaves everything as it was
+	v.shrink_to_fit();
+	ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+	ASSERT_THROW(v.reserve(CREATE_COUNT * 2), std::runtime_error);
+	ASSERT_EQ(v.capacity(), CREATE_COUNT);
+	ThrowingMoveObj::copiesUntilThrow = CREATE_COUNT / 2;
+	ASSERT_THROW(v.insert(v.begin() + 1, ThrowingMoveObj(-1)), std::runtime_error);
+	ASSERT_EQ(v.size(), CREATE_COUNT);
+	for (int i=0; i<CREATE_COUNT; ++i) {
+		ASSERT_EQ(v[i].value, i);
+	}
+}
+
+TEST(Move, adlSwap) {
+	sandsnip3r::vector<int> left{1, 2, 3};
+	sandsnip3r::vector<int> right{4};
+	using std::swap;
+	static_assert(noexcept(swap(left, right)), "");
+	swap(left, right);
+	ASSERT_EQ(left.size(), 1);
+	ASSERT_EQ(right.size(), 3);
+
+	sandsnip3r::small_vector<int, 4> smallLeft{1, 2};
+	sandsnip3r::small_vector<int, 4> smallRight{3, 4, 5, 6, 7};
+	swap(smallLeft, smallRight);
+	ASSERT_EQ(smallLeft.size(), 5);
+	ASSERT_EQ(smallRight.size(), 2);
+	ASSERT_EQ(smallRight[1], 2);
+}
+TEST(FlatMap, branchlessSearchMatchesStd) {
+	std::vector<int> sorted;
+	for (int i=0; i<200; ++i) {
+		sorted.push_back(i / 3 * 2);
+	}
+	for (size_t count=0; count<=sorted.size(); count+=7) {
+		for (int key=-1; key<140; ++key) {
+			auto found = sandsnip3r::detail::branchlessPartitionPoint(sorted.begin(), count, [&](int value) {
+				return value < key;
+			});
+			ASSERT_EQ(found, std::lower_bound(sorted.begin(), sorted.begin() + count, key));
+		}
+	}
+}
+
+TEST(FlatMap, flatSet) {
+	sandsnip3r::flat_set<int> set{5, 3, 9, 3, 1, 5};
+	ASSERT_EQ(set.size(), 4);
+	ASSERT_TRUE(std::is_sorted(set.begin(), set.end()));
+	ASSERT_TRUE(set.contains(9));
+	ASSERT_FALSE(set.contains(4));
+	ASSERT_EQ(set.find(4), set.end());
+	ASSERT_EQ(*set.lower_bound(4), 5);
+
+	ASSERT_TRUE(set.insert(4).second);
+	ASSERT_FALSE(set.insert(4).second);
+	ASSERT_EQ(set.erase(3), 1);
+	ASSERT_EQ(set.erase(3), 0);
+
+	//Hints right and wrong both end up sorted
+	set.insert(set.end(), 10);
+	set.insert(set.begin(), 7);
+	set.insert(set.begin(), 0);
+	ASSERT_EQ(std::vector<int>(set.begin(), set.end()), std::vector<int>({0, 1, 4, 5, 7, 9, 10}));
+
+	//Bulk insert sorts and merges once
+	const std::vector<int> more{8, 2, 10, 6, 2};
+	set.insert(more.begin(), more.end());
+	ASSERT_EQ(set.size(), 10);
+	ASSERT_TRUE(std::adjacent_find(set.begin(), set.end()) == set.end());
+
+	ASSERT_EQ(sandsnip3r::erase_if(set, [](int value) { return value % 2 == 1; }), 4);
+	ASSERT_EQ(std::vector<int>(set.begin(), set.end()), std::vector<int>({0, 2, 4, 6, 8, 10}));
+}
+
+TEST(FlatMap, extractAndReplace) {
+	sandsnip3r::flat_set<int> set(sandsnip3r::sorted_unique, {1, 2, 3});
+	const int *storage = &*set.begin();
+	sandsnip3r::vector<int> values = set.extract();
+	ASSERT_TRUE(set.empty());
+	ASSERT_EQ(values.data(), storage);
+	values.push_back(4);
+	storage = values.data();
+	set.replace(std::move(values));
+	ASSERT_EQ(&*set.begin(), storage);
+	ASSERT_EQ(set.size(), 4);
+
+	sandsnip3r::vector<int> unsorted{3, 1, 2, 1};
+	sandsnip3r::flat_set<int> adopted(std::move(unsorted));
+	ASSERT_EQ(std::vector<int>(adopted.begin(), adopted.end()), std::vector<int>({1, 2, 3}));
+}
+
+TEST(FlatMap, flatMap) {
+	static_assert(sandsnip3r::is_trivially_relocatable_v<std::pair<int, double>>, "");
+	static_assert(!sandsnip3r::is_trivially_relocatable_v<std::pair<int, std::string>>, "");
+
+	//The first of repeated keys wins, like inserting them one at a time
+	sandsnip3r::flat_map<std::string, int> map{{"b", 2}, {"a", 1}, {"b", 3}};
+	ASSERT_EQ(map.size(), 2);
+	ASSERT_EQ(map.at("b"), 2);
+	ASSERT_THROW(map.at("z"), std::out_of_range);
+
+	map["c"] = 5;
+	++map["a"];
+	ASSERT_EQ(map["a"], 2);
+	ASSERT_EQ(map.begin()->first, "a");
+
+	ASSERT_FALSE(map.try_emplace("c", 9).second);
+	ASSERT_EQ(map.at("c"), 5);
+	ASSERT_FALSE(map.insert_or_assign("c", 9).second);
+	ASSERT_EQ(map.at("c"), 9);
+	ASSERT_TRUE(map.insert_or_assign("d", 4).second);
+
+	auto it = map.find("b");
+	it->second = 20;
+	ASSERT_EQ(map.at("b"), 20);
+	map.erase(it);
+	ASSERT_FALSE(map.contains("b"));
+	ASSERT_EQ(map.size(), 3);
+
+	const auto &constMap = map;
+	ASSERT_EQ(constMap.find("d")->second, 4);
+	ASSERT_EQ(constMap.count("d"), 1);
+
+	//Existing keys are kept over those in the range
+	const std::vector<std::pair<std::string, int>> more{{"a", 100}, {"e", 6}};
+	map.insert(more.begin(), more.end());
+	ASSERT_EQ(map.at("a"), 2);
+	ASSERT_EQ(map.at("e"), 6);
+
+	sandsnip3r::flat_map<std::string, int> other;
+	swap(map, other);
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(other.size(), 4);
+}
+
+TEST(FlatMap, flatMultimap) {
+	sandsnip3r::flat_multimap<int, char> map{{2, 'a'}, {1, 'b'}, {2, 'c'}};
+	map.insert({2, 'd'});
+	map.insert(map.begin(), {2, 'e'});
+	ASSERT_EQ(map.size(), 5);
+	ASSERT_EQ(map.count(2), 4);
+	auto range = map.equal_range(2);
+	std::string values;
+	for (auto it=range.first; it!=range.second; ++it) {
+		values += it->second;
+	}
+	//The wrong hint falls back to inserting after the other 2s
+	ASSERT_EQ(values, "acde");
+	ASSERT_EQ(map.erase(2), 4);
+	ASSERT_EQ(map.size(), 1);
+}
+
+TEST(SoaVector, columnsAreContiguousAndAligned) {
+	sandsnip3r::soa_vector<float, double, char> particles;
+	for (int i=0; i<100; ++i) {
+		particles.emplace_back(static_cast<float>(i), i * 2.0, static_cast<char>('a' + i % 26));
+	}
+	ASSERT_EQ(particles.size(), 100);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(particles.data<0>()) % 64, 0);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(particles.data<1>()) % 64, 0);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(particles.data<2>()) % 64, 0);
+
+	//One column can be scanned on its own
+	const auto positions = particles.column<0>();
+	ASSERT_EQ(positions.size(), 100);
+	ASSERT_EQ(std::accumulate(positions.begin(), positions.end(), 0.0f), 4950.0f);
+	for (auto &velocity : particles.column<1>()) {
+		velocity *= 2;
+	}
+
+	//Rows come back as tuples of references
+	auto row = particles[10];
+	ASSERT_EQ(std::get<0>(row), 10.0f);
+	ASSERT_EQ(std::get<1>(row), 40.0);
+	std::get<2>(row) = 'z';
+	ASSERT_EQ(std::get<2>(particles.at(10)), 'z');
+	ASSERT_THROW(particles.at(100), std::out_of_range);
+
+	size_t visited = 0;
+	for (auto it=particles.begin(); it!=particles.end(); ++it) {
+		float position;
+		double velocity;
+		char tag;
+		std::tie(position, velocity, tag) = *it;
+		ASSERT_EQ(velocity, position * 4.0);
+		++visited;
+	}
+	ASSERT_EQ(visited, 100);
+}
+
+TEST(SoaVector, vectorInterface) {
+	sandsnip3r::soa_vector<int, std::string> table;
+	table.push_back(std::make_tuple(1, std::string("one")));
+	table.emplace_back(2, "two");
+	table.emplace_back(3, std::string(100, 'x'));
+	table.reserve(50);
+	ASSERT_EQ(table.capacity(), 50);
+	ASSERT_EQ(std::get<1>(table[1]), "two");
+
+	//Appending a copy of one of our own rows while growing
+	table.shrink_to_fit();
+	table.push_back(table.front());
+	ASSERT_EQ(table.size(), 4);
+	ASSERT_EQ(std::get<1>(table.back()), "one");
+
+	table.erase(table.begin() + 1);
+	ASSERT_EQ(table.size(), 3);
+	ASSERT_EQ(std::get<0>(table[1]), 3);
+	ASSERT_EQ(std::get<1>(table[1]).size(), 100);
+
+	sandsnip3r::soa_vector<int, std::string> copy(table);
+	ASSERT_EQ(copy, table);
+	sandsnip3r::soa_vector<int, std::string> moved(std::move(copy));
+	ASSERT_TRUE(copy.empty());
+	ASSERT_EQ(moved, table);
+
+	table.resize(10);
+	ASSERT_EQ(std::get<0>(table[9]), 0);
+	ASSERT_EQ(std::get<1>(table[9]), "");
+	table.pop_back();
+	ASSERT_EQ(table.size(), 9);
+	ASSERT_NE(moved, table);
+	moved = table;
+	ASSERT_EQ(moved, table);
+	swap(moved, copy);
+	ASSERT_TRUE(moved.empty());
+	ASSERT_EQ(copy.size(), 9);
+	table.clear();
+	ASSERT_TRUE(table.empty());
+}
+
+TEST(SoaVector, moveAssignmentWithUnequalAllocators) {
+	//Move-only columns, so the rows have to be moved rather than copied into our own storage
+	using Table = sandsnip3r::basic_soa_vector<CountingAllocator<int>, sandsnip3r::golden_ratio_growth, 64, int, std::unique_ptr<int>>;
+	AllocationCounts::resetCounts();
+	{
+		Table first(CountingAllocator<int>(1));
+		Table second(CountingAllocator<int>(2));
+		first.emplace_back(0, std::make_unique<int>(0));
+		for (int i=0; i<10; ++i) {
+			second.emplace_back(i, std::make_unique<int>(i * 10));
+		}
+		first = std::move(second);
+		ASSERT_EQ(first.get_allocator().id, 1);
+		ASSERT_EQ(first.size(), 10);
+		for (int i=0; i<10; ++i) {
+			ASSERT_EQ(std::get<0>(first[i]), i);
+			ASSERT_EQ(*std::get<1>(first[i]), i * 10);
+		}
+	}
+	ASSERT_EQ(AllocationCounts::allocations, AllocationCounts::deallocations);
+}
+
+TEST(SoaVector, failedGrowthChangesNothing) {
+	sandsnip3r::soa_vector<int, ThrowingMoveObj, std::string> rows;
+	for (int i=0; i<10; ++i) {
+		rows.emplace_back(i, ThrowingMoveObj(i), std::to_string(i));
+	}
+	rows.shrink_to_fit();
+	ThrowingMoveObj::copiesUntilThrow = 5;
+	ASSERT_THROW(rows.reserve(20), std::runtime_error);
+	ThrowingMoveObj::copiesUntilThrow = std::numeric_limits<int>::max();
+	ASSERT_EQ(rows.capacity(), 10);
+	for (int i=0; i<10; ++i) {
+		ASSERT_EQ(std::get<1>(rows[i]).value, i);
+		ASSERT_EQ(std::get<2>(rows[i]), std::to_string(i));
+	}
+}
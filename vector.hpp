@@ -2,15 +2,1118 @@
 #define VECTOR_HPP 1
 
 #include <algorithm>
-#include <cmath>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(SANDSNIP3R_VECTOR_STATS) || defined(SANDSNIP3R_VECTOR_PARALLEL)
+#include <atomic>
+#endif
+
+#ifdef SANDSNIP3R_VECTOR_PARALLEL
+#include <exception>
+#include <system_error>
+#include <thread>
+#endif
 
 namespace sandsnip3r {
 
-	template<class Type, class Allocator = std::allocator<Type>>
-	class vector {
+	//A type is trivially relocatable if moving an object to a new address and then destroying the
+	//	original is equivalent to copying its bytes and forgetting about the original
+	//Every trivially copyable type qualifies. Other types (unique_ptr-like handles, for example) can opt
+	//	in by specializing this trait
+	template<class Type>
+	struct is_trivially_relocatable : std::is_trivially_copyable<Type> {};
+
+	template<class Type>
+	constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<Type>::value;
+
+	//std::pair isn't trivially copyable (its assignment is user-provided) but relocating it only relocates
+	//	its members
+	template<class First, class Second>
+	struct is_trivially_relocatable<std::pair<First, Second>> : std::integral_constant<bool, is_trivially_relocatable_v<First> && is_trivially_relocatable_v<Second>> {};
+
+#ifdef SANDSNIP3R_VECTOR_PARALLEL
+	//Define SANDSNIP3R_VECTOR_PARALLEL to have fills, copies and relocations of at least
+	//	parallel_threshold() elements split into chunks across threads
+	//	Without it none of this exists and everything runs on the calling thread
+
+	namespace detail {
+		inline std::atomic<std::size_t> parallelThreshold{std::size_t(1) << 20};
+	}
+
+	inline std::size_t parallel_threshold() {
+		return detail::parallelThreshold.load(std::memory_order_relaxed);
+	}
+
+	inline void set_parallel_threshold(std::size_t elements) {
+		detail::parallelThreshold.store(elements, std::memory_order_relaxed);
+	}
+
+	namespace detail {
+
+		inline bool isParallel(std::size_t count) {
+			return count >= 2 && count >= parallel_threshold();
+		}
+
+		//Splits [0, count) into one chunk per hardware thread and runs body(begin, end) on each, the first
+		//	on the calling thread. body must either finish its chunk or undo its own work and throw
+		//If any chunk throws, undo(begin, end) is called for every chunk that finished and the first
+		//	exception is rethrown
+		template<class Body, class Undo>
+		void parallelFor(std::size_t count, Body body, Undo undo) {
+			const std::size_t chunkCount = std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 2u), count);
+			const std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+			std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[chunkCount]);
+			auto runChunk = [&](std::size_t chunk) {
+				try {
+					body(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+				} catch (...) {
+					errors[chunk] = std::current_exception();
+				}
+			};
+			std::unique_ptr<std::thread[]> threads(new std::thread[chunkCount - 1]);
+			std::size_t started = 0;
+			try {
+				for (; started<chunkCount-1; ++started) {
+					threads[started] = std::thread(runChunk, started + 1);
+				}
+			} catch (const std::system_error &) {
+				//Out of threads, the calling thread does the rest
+			}
+			for (std::size_t chunk=started+1; chunk<chunkCount; ++chunk) {
+				runChunk(chunk);
+			}
+			runChunk(0);
+			for (std::size_t i=0; i<started; ++i) {
+				threads[i].join();
+			}
+			std::exception_ptr firstError;
+			for (std::size_t chunk=0; chunk<chunkCount; ++chunk) {
+				if (errors[chunk] && !firstError) {
+					firstError = errors[chunk];
+				}
+			}
+			if (firstError) {
+				for (std::size_t chunk=0; chunk<chunkCount; ++chunk) {
+					if (!errors[chunk]) {
+						undo(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+					}
+				}
+				std::rethrow_exception(firstError);
+			}
+		}
+	}
+#endif
+
+	namespace detail {
+
+		//Whether relocating Type can't throw, so elements can be moved rather than copied to a new buffer
+		template<class Type>
+		constexpr bool relocates_without_throwing = is_trivially_relocatable_v<Type> || std::is_nothrow_move_constructible<Type>::value;
+
+		//Move-constructs [first, last) into the uninitialized memory at destination if that can't throw and
+		//	copy-constructs otherwise (like std::move_if_noexcept), leaving the originals alive
+		//If a constructor throws, the elements constructed so far are destroyed again
+		template<class Allocator, class Pointer>
+		Pointer uninitializedMoveIfNoexcept(Allocator &alloc, Pointer first, Pointer last, Pointer destination) {
+			Pointer current = destination;
+			try {
+				for (; first != last; ++first, ++current) {
+					std::allocator_traits<Allocator>::construct(alloc, current, std::move_if_noexcept(*first));
+				}
+			} catch (...) {
+				for (; destination != current; ++destination) {
+					std::allocator_traits<Allocator>::destroy(alloc, destination);
+				}
+				throw;
+			}
+			return current;
+		}
+
+		//Copies the bytes of count elements from source to destination, which must not overlap
+		template<class Type>
+		void copyBytes(Type *destination, const Type *source, std::size_t count) {
+#ifdef SANDSNIP3R_VECTOR_PARALLEL
+			if (count > 0 && isParallel(count)) {
+				parallelFor(count, [&](std::size_t begin, std::size_t end) {
+					std::memcpy(static_cast<void*>(destination + begin), static_cast<const void*>(source + begin), (end - begin) * sizeof(Type));
+				}, [](std::size_t, std::size_t) {});
+				return;
+			}
+#endif
+			if (count > 0) {
+				std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(Type));
+			}
+		}
+
+		//Moves the elements of [first, last) into the uninitialized memory at destination and ends the
+		//	lifetime of the originals, returning the end of the destination range
+		//Trivially relocatable types are moved as a single block of bytes, everything else is moved one
+		//	element at a time through the allocator. Types whose move constructor may throw are copied
+		//	instead, and the originals are only destroyed once every copy succeeded, so if this throws
+		//	[first, last) is untouched and nothing is left at destination
+		template<class Allocator, class Pointer>
+		Pointer relocate(Allocator &alloc, Pointer first, Pointer last, Pointer destination) {
+			using value_type = typename std::allocator_traits<Allocator>::value_type;
+			if constexpr (is_trivially_relocatable_v<value_type>) {
+				const auto count = last - first;
+				copyBytes(destination, first, count);
+				return destination + count;
+			} else {
+#ifdef SANDSNIP3R_VECTOR_PARALLEL
+				//A throwing move would leave other chunks half relocated, so those stay on one thread
+				const auto count = last - first;
+				if (std::is_nothrow_move_constructible<value_type>::value && count > 0 && isParallel(count)) {
+					parallelFor(count, [&](std::size_t begin, std::size_t end) {
+						for (std::size_t i=begin; i<end; ++i) {
+							std::allocator_traits<Allocator>::construct(alloc, destination + i, std::move(first[i]));
+							std::allocator_traits<Allocator>::destroy(alloc, first + i);
+						}
+					}, [](std::size_t, std::size_t) {});
+					return destination + count;
+				}
+#endif
+				if constexpr (!std::is_nothrow_move_constructible<value_type>::value) {
+					Pointer destinationEnd = uninitializedMoveIfNoexcept(alloc, first, last, destination);
+					for (; first != last; ++first) {
+						std::allocator_traits<Allocator>::destroy(alloc, first);
+					}
+					return destinationEnd;
+				}
+				while (first != last) {
+					std::allocator_traits<Allocator>::construct(alloc, destination, std::move(*first));
+					std::allocator_traits<Allocator>::destroy(alloc, first);
+					++first;
+					++destination;
+				}
+				return destination;
+			}
+		}
+
+		template<class Allocator, class Pointer>
+		void destroyRange(Allocator &alloc, Pointer first, Pointer last) {
+			using value_type = typename std::allocator_traits<Allocator>::value_type;
+			if constexpr (!std::is_trivially_destructible<value_type>::value) {
+				for (; first != last; ++first) {
+					std::allocator_traits<Allocator>::destroy(alloc, first);
+				}
+			}
+		}
+
+		//Fills the new buffer at destination for an insertion of count elements at position: the new
+		//	elements are constructed by constructElements(gap) and [first, position) and [position, last)
+		//	are relocated around them
+		//constructElements must construct all count elements or none and throw. If anything throws,
+		//	[first, last) is untouched and nothing is left at destination
+		template<class Allocator, class Pointer, class ConstructElements>
+		void relocateAroundGap(Allocator &alloc, Pointer first, Pointer position, Pointer last, Pointer destination, std::size_t count, ConstructElements constructElements) {
+			using value_type = typename std::allocator_traits<Allocator>::value_type;
+			Pointer gap = destination + (position - first);
+			constructElements(gap);
+			if constexpr (relocates_without_throwing<value_type>) {
+				relocate(alloc, first, position, destination);
+				relocate(alloc, position, last, gap + count);
+			} else {
+				//Copy both halves before destroying anything, so a throwing copy changes nothing
+				try {
+					uninitializedMoveIfNoexcept(alloc, first, position, destination);
+					try {
+						uninitializedMoveIfNoexcept(alloc, position, last, gap + count);
+					} catch (...) {
+						destroyRange(alloc, destination, gap);
+						throw;
+					}
+				} catch (...) {
+					destroyRange(alloc, gap, gap + count);
+					throw;
+				}
+				destroyRange(alloc, first, last);
+			}
+		}
+
+		//Inserts count elements at position into a buffer with room for them after last, constructing them
+		//	with constructElements like relocateAroundGap. If that throws, nothing has changed
+		template<class Pointer, class ConstructElements>
+		void insertInPlace(Pointer position, Pointer last, std::size_t count, ConstructElements constructElements) {
+			using value_type = typename std::iterator_traits<Pointer>::value_type;
+			if constexpr (is_trivially_relocatable_v<value_type>) {
+				const std::size_t tailBytes = (last - position) * sizeof(value_type);
+				std::memmove(static_cast<void*>(position + count), static_cast<const void*>(position), tailBytes);
+				try {
+					constructElements(position);
+				} catch (...) {
+					//Close the gap again
+					std::memmove(static_cast<void*>(position), static_cast<const void*>(position + count), tailBytes);
+					throw;
+				}
+			} else {
+				//Construct at the end and rotate into place
+				constructElements(last);
+				std::rotate(position, last, last + count);
+			}
+		}
+
+		//Replaces the size elements at first with the count starting at source, in a buffer with room for
+		//	count. Elements already there are copy-assigned over, so whatever they own (a string's buffer,
+		//	say) is reused, and only the difference is constructed by constructRange(destination, source, n)
+		//	or destroyed
+		template<class Allocator, class Pointer, class ForwardIt, class ConstructRange>
+		void assignOver(Allocator &alloc, Pointer first, std::size_t size, ForwardIt source, std::size_t count, ConstructRange constructRange) {
+			const std::size_t common = std::min(size, count);
+			ForwardIt commonEnd = std::next(source, common);
+			std::copy(source, commonEnd, first);
+			if (count > common) {
+				constructRange(first + common, commonEnd, count - common);
+			} else {
+				destroyRange(alloc, first + count, first + size);
+			}
+		}
+
+		template<class SizeType>
+		constexpr SizeType saturatingAdd(SizeType left, SizeType right) {
+			return (left > std::numeric_limits<SizeType>::max() - right ? std::numeric_limits<SizeType>::max() : left + right);
+		}
+
+		constexpr std::size_t roundUp(std::size_t value, std::size_t multiple) {
+			return (value + multiple - 1) / multiple * multiple;
+		}
+
+		//Index of the highest set bit, value must not be 0
+		inline std::size_t floorLog2(std::size_t value) {
+#if defined(__GNUC__)
+			return std::numeric_limits<unsigned long long>::digits - 1 - __builtin_clzll(value);
+#else
+			std::size_t result = 0;
+			while (value >>= 1) {
+				++result;
+			}
+			return result;
+#endif
+		}
+
+		//Storage split into segments that double in size and never move: segment k holds
+		//	FirstSegmentSize << k elements, so index i is in segment floorLog2(i + FirstSegmentSize) - log2(FirstSegmentSize)
+		template<std::size_t FirstSegmentSize>
+		struct geometric_segments {
+			static_assert(FirstSegmentSize != 0 && (FirstSegmentSize & (FirstSegmentSize - 1)) == 0, "FirstSegmentSize must be a power of two");
+
+			static constexpr std::size_t firstSegmentBits() {
+				std::size_t bits = 0;
+				while ((std::size_t(1) << bits) < FirstSegmentSize) {
+					++bits;
+				}
+				return bits;
+			}
+
+			//Enough segments to cover every index a std::size_t can hold
+			static constexpr std::size_t SEGMENT_COUNT = std::numeric_limits<std::size_t>::digits - firstSegmentBits();
+
+			static std::size_t segmentOf(std::size_t index) {
+				return floorLog2(index + FirstSegmentSize) - firstSegmentBits();
+			}
+
+			static constexpr std::size_t segmentSize(std::size_t segment) {
+				return FirstSegmentSize << segment;
+			}
+
+			//Index of the first element in segment
+			static constexpr std::size_t segmentBegin(std::size_t segment) {
+				return segmentSize(segment) - FirstSegmentSize;
+			}
+
+			static constexpr std::size_t offsetInSegment(std::size_t index, std::size_t segment) {
+				return index - segmentBegin(segment);
+			}
+		};
+
+		//Random access iterator over a container indexed through operator[], for storage that isn't contiguous
+		//	Reference is what operator[] returns, which may be a proxy (operator-> then isn't available)
+		template<class Container, class Value, class Reference = Value&>
+		class indexed_iterator {
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type 				= std::remove_const_t<Value>;
+			using difference_type 	= std::ptrdiff_t;
+			using pointer 					= Value*;
+			using reference 				= Reference;
+
+			indexed_iterator() = default;
+
+			indexed_iterator(Container *container, std::size_t index) : container(container), index(index) {}
+
+			//iterator -> const_iterator
+			template<class OtherContainer, class OtherValue, class OtherReference, typename = std::enable_if_t<std::is_convertible<OtherValue*, Value*>::value>>
+			indexed_iterator(const indexed_iterator<OtherContainer, OtherValue, OtherReference> &other) : container(other.container), index(other.index) {}
+
+			reference operator*() const {
+				return (*container)[index];
+			}
+
+			pointer operator->() const {
+				return std::addressof((*container)[index]);
+			}
+
+			reference operator[](difference_type n) const {
+				return (*container)[index + n];
+			}
+
+			indexed_iterator& operator++() {
+				++index;
+				return *this;
+			}
+
+			indexed_iterator operator++(int) {
+				indexed_iterator copy(*this);
+				++index;
+				return copy;
+			}
+
+			indexed_iterator& operator--() {
+				--index;
+				return *this;
+			}
+
+			indexed_iterator operator--(int) {
+				indexed_iterator copy(*this);
+				--index;
+				return copy;
+			}
+
+			indexed_iterator& operator+=(difference_type n) {
+				index += n;
+				return *this;
+			}
+
+			indexed_iterator& operator-=(difference_type n) {
+				index -= n;
+				return *this;
+			}
+
+			friend indexed_iterator operator+(indexed_iterator it, difference_type n) {
+				return it += n;
+			}
+
+			friend indexed_iterator operator+(difference_type n, indexed_iterator it) {
+				return it += n;
+			}
+
+			friend indexed_iterator operator-(indexed_iterator it, difference_type n) {
+				return it -= n;
+			}
+
+			friend difference_type operator-(const indexed_iterator &left, const indexed_iterator &right) {
+				return static_cast<difference_type>(left.index) - static_cast<difference_type>(right.index);
+			}
+
+			friend bool operator==(const indexed_iterator &left, const indexed_iterator &right) {
+				return left.index == right.index;
+			}
+
+			friend bool operator!=(const indexed_iterator &left, const indexed_iterator &right) {
+				return left.index != right.index;
+			}
+
+			friend bool operator<(const indexed_iterator &left, const indexed_iterator &right) {
+				return left.index < right.index;
+			}
+
+			friend bool operator>(const indexed_iterator &left, const indexed_iterator &right) {
+				return left.index > right.index;
+			}
+
+			friend bool operator<=(const indexed_iterator &left, const indexed_iterator &right) {
+				return left.index <= right.index;
+			}
+
+			friend bool operator>=(const indexed_iterator &left, const indexed_iterator &right) {
+				return left.index >= right.index;
+			}
+
+		private:
+			template<class OtherContainer, class OtherValue, class OtherReference>
+			friend class indexed_iterator;
+
+			Container *container{nullptr};
+			std::size_t index{0};
+		};
+
+		//Allocators may optionally provide either of these members, which vector uses before falling back
+		//	to allocate + relocate + deallocate:
+		//	bool expand(pointer p, size_type oldCapacity, size_type newCapacity)
+		//		Resize the allocation at p without moving it. Returns false if that isn't possible
+		//	pointer reallocate(pointer p, size_type oldCapacity, size_type newCapacity)
+		//		realloc-style resize that may move the bytes to a new address. Only used for trivially
+		//		relocatable types. Throws std::bad_alloc on failure, leaving p untouched
+		template<class Allocator, class = void>
+		struct has_expand : std::false_type {};
+
+		template<class Allocator>
+		struct has_expand<Allocator, std::void_t<decltype(
+			std::declval<Allocator&>().expand(
+				std::declval<typename std::allocator_traits<Allocator>::pointer>(),
+				std::declval<typename std::allocator_traits<Allocator>::size_type>(),
+				std::declval<typename std::allocator_traits<Allocator>::size_type>())
+		)>> : std::true_type {};
+
+		template<class Allocator, class = void>
+		struct has_reallocate : std::false_type {};
+
+		template<class Allocator>
+		struct has_reallocate<Allocator, std::void_t<decltype(
+			std::declval<Allocator&>().reallocate(
+				std::declval<typename std::allocator_traits<Allocator>::pointer>(),
+				std::declval<typename std::allocator_traits<Allocator>::size_type>(),
+				std::declval<typename std::allocator_traits<Allocator>::size_type>())
+		)>> : std::true_type {};
+
+		//Whether the allocator constructs elements itself, in which case copies can't be made with memcpy
+		//	std::allocator's construct (until C++20) is plain placement new, so it doesn't count
+		template<class Allocator, class Arg, class = void>
+		struct has_construct : std::false_type {};
+
+		template<class Allocator, class Arg>
+		struct has_construct<Allocator, Arg, std::void_t<decltype(
+			std::declval<Allocator&>().construct(
+				std::declval<typename std::allocator_traits<Allocator>::pointer>(),
+				std::declval<Arg>())
+		)>> : std::negation<std::is_same<Allocator, std::allocator<typename std::allocator_traits<Allocator>::value_type>>> {};
+	}
+
+	//An allocator backed by malloc/realloc/free which vector can grow without copying
+	//Allocations of at least MmapThreshold bytes are mapped directly from the kernel so that they can
+	//	be grown with mremap, which moves page table entries rather than bytes
+	template<class Type, std::size_t MmapThreshold = (std::size_t(1) << 20)>
+	class malloc_allocator {
+	public:
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= Type*;
+		using const_pointer 	= const Type*;
+		using is_always_equal = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+
+		template<class Other>
+		struct rebind {
+			using other = malloc_allocator<Other, MmapThreshold>;
+		};
+
+		static_assert(alignof(Type) <= alignof(std::max_align_t), "malloc_allocator cannot satisfy over-aligned types");
+
+		malloc_allocator() = default;
+
+		template<class Other>
+		malloc_allocator(const malloc_allocator<Other, MmapThreshold> &) {}
+
+		pointer allocate(size_type count) {
+			if (count == 0) {
+				return nullptr;
+			}
+			if (count > max_size()) {
+				throw std::bad_array_new_length();
+			}
+			const auto bytes = count * sizeof(Type);
+			void *memory = (isMapped(bytes) ? mapPages(bytes) : std::malloc(bytes));
+			if (memory == nullptr) {
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer>(memory);
+		}
+
+		void deallocate(pointer data, size_type count) {
+			if (data == nullptr) {
+				return;
+			}
+			const auto bytes = count * sizeof(Type);
+			if (isMapped(bytes)) {
+				unmapPages(data, bytes);
+			} else {
+				std::free(data);
+			}
+		}
+
+		bool expand(pointer data, size_type oldCount, size_type newCount) {
+			if (data == nullptr) {
+				return false;
+			}
+			const auto oldBytes = oldCount * sizeof(Type);
+			const auto newBytes = newCount * sizeof(Type);
+			if (isMapped(oldBytes) != isMapped(newBytes)) {
+				//Would have to change between malloc and mmap
+				return false;
+			}
+			if (!isMapped(oldBytes)) {
+#if defined(__GLIBC__)
+				//Malloc usually hands out more than was asked for
+				return newBytes <= malloc_usable_size(data);
+#else
+				return false;
+#endif
+			}
+#if defined(__linux__)
+			const auto oldMapping = roundToPage(oldBytes);
+			const auto newMapping = roundToPage(newBytes);
+			if (oldMapping == newMapping) {
+				return true;
+			}
+			return mremap(data, oldMapping, newMapping, 0) != MAP_FAILED;
+#else
+			return false;
+#endif
+		}
+
+		pointer reallocate(pointer data, size_type oldCount, size_type newCount) {
+			if (newCount == 0) {
+				deallocate(data, oldCount);
+				return nullptr;
+			}
+			if (newCount > max_size()) {
+				throw std::bad_array_new_length();
+			}
+			const auto oldBytes = oldCount * sizeof(Type);
+			const auto newBytes = newCount * sizeof(Type);
+			void *memory = nullptr;
+			if (!isMapped(oldBytes) && !isMapped(newBytes)) {
+				memory = std::realloc(data, newBytes);
+			}
+#if defined(__linux__)
+			else if (isMapped(oldBytes) && isMapped(newBytes)) {
+				memory = mremap(data, roundToPage(oldBytes), roundToPage(newBytes), MREMAP_MAYMOVE);
+				if (memory == MAP_FAILED) {
+					memory = nullptr;
+				}
+			}
+#endif
+			else {
+				//Crossing the threshold, the bytes have to be copied between the two kinds of memory
+				pointer newData = allocate(newCount);
+				if (data != nullptr) {
+					std::memcpy(static_cast<void*>(newData), static_cast<const void*>(data), std::min(oldBytes, newBytes));
+					deallocate(data, oldCount);
+				}
+				return newData;
+			}
+			if (memory == nullptr) {
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer>(memory);
+		}
+
+		size_type max_size() const {
+			return std::numeric_limits<size_type>::max() / sizeof(Type);
+		}
+
+		friend bool operator==(const malloc_allocator &, const malloc_allocator &) {
+			return true;
+		}
+
+		friend bool operator!=(const malloc_allocator &, const malloc_allocator &) {
+			return false;
+		}
+
+	private:
+		static bool isMapped(std::size_t bytes) {
+#if defined(__linux__)
+			return bytes >= MmapThreshold;
+#else
+			return false;
+#endif
+		}
+
+#if defined(__linux__)
+		static std::size_t roundToPage(std::size_t bytes) {
+			static const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+			return (bytes + pageSize - 1) / pageSize * pageSize;
+		}
+
+		static void* mapPages(std::size_t bytes) {
+			void *memory = mmap(nullptr, roundToPage(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			return (memory == MAP_FAILED ? nullptr : memory);
+		}
+
+		static void unmapPages(void *memory, std::size_t bytes) {
+			munmap(memory, roundToPage(bytes));
+		}
+#else
+		static void* mapPages(std::size_t bytes) {
+			return std::malloc(bytes);
+		}
+
+		static void unmapPages(void *memory, std::size_t) {
+			std::free(memory);
+		}
+#endif
+	};
+
+	//An allocator which aligns every buffer to Alignment bytes (at most a page), for SIMD loads
+	//Allocations of at least HugePageThreshold bytes are mapped directly, aligned to 2 MiB and marked
+	//	with MADV_HUGEPAGE so that they can be backed by transparent huge pages. With Prefault, every page
+	//	is touched as it is allocated (which includes reserve()), so page faults aren't taken later
+	template<class Type, std::size_t Alignment = 64, std::size_t HugePageThreshold = (std::size_t(2) << 20), bool Prefault = false>
+	class aligned_allocator {
+	public:
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= Type*;
+		using const_pointer 	= const Type*;
+		using is_always_equal = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+
+		template<class Other>
+		struct rebind {
+			using other = aligned_allocator<Other, Alignment, HugePageThreshold, Prefault>;
+		};
+
+		static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "aligned_allocator Alignment must be a power of two");
+		static_assert(Alignment >= alignof(Type), "aligned_allocator Alignment must be at least alignof(Type)");
+		static_assert(Alignment <= 4096, "aligned_allocator Alignment can be at most the page size");
+
+		aligned_allocator() = default;
+
+		template<class Other>
+		aligned_allocator(const aligned_allocator<Other, Alignment, HugePageThreshold, Prefault> &) {}
+
+		static constexpr std::size_t alignment() {
+			return Alignment;
+		}
+
+		pointer allocate(size_type count) {
+			if (count == 0) {
+				return nullptr;
+			}
+			if (count > max_size()) {
+				throw std::bad_array_new_length();
+			}
+			const auto bytes = count * sizeof(Type);
+			void *memory = (isMapped(bytes) ? mapHugePages(bytes) : std::aligned_alloc(Alignment, detail::roundUp(bytes, Alignment)));
+			if (memory == nullptr) {
+				throw std::bad_alloc();
+			}
+			if constexpr (Prefault) {
+				prefault(memory, 0, bytes);
+			}
+			return static_cast<pointer>(memory);
+		}
+
+		void deallocate(pointer data, size_type count) {
+			if (data == nullptr) {
+				return;
+			}
+			const auto bytes = count * sizeof(Type);
+			if (isMapped(bytes)) {
+				unmapHugePages(data, bytes);
+			} else {
+				std::free(data);
+			}
+		}
+
+		//Only mappings can grow in place, they stay aligned since they aren't moved
+		bool expand(pointer data, size_type oldCount, size_type newCount) {
+			const auto oldBytes = oldCount * sizeof(Type);
+			const auto newBytes = newCount * sizeof(Type);
+			if (data == nullptr || !isMapped(oldBytes) || !isMapped(newBytes)) {
+				return false;
+			}
+#if defined(__linux__)
+			const auto oldMapping = detail::roundUp(oldBytes, HUGE_PAGE_SIZE);
+			const auto newMapping = detail::roundUp(newBytes, HUGE_PAGE_SIZE);
+			if (oldMapping != newMapping && mremap(data, oldMapping, newMapping, 0) == MAP_FAILED) {
+				return false;
+			}
+			if constexpr (Prefault) {
+				prefault(data, oldBytes, newBytes);
+			}
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		size_type max_size() const {
+			return (std::numeric_limits<size_type>::max() - HUGE_PAGE_SIZE) / sizeof(Type);
+		}
+
+		friend bool operator==(const aligned_allocator &, const aligned_allocator &) {
+			return true;
+		}
+
+		friend bool operator!=(const aligned_allocator &, const aligned_allocator &) {
+			return false;
+		}
+
+	private:
+		static constexpr std::size_t HUGE_PAGE_SIZE = (std::size_t(2) << 20);
+
+		static bool isMapped(std::size_t bytes) {
+#if defined(__linux__)
+			return bytes >= HugePageThreshold;
+#else
+			return false;
+#endif
+		}
+
+		//Write to one byte of every page in [begin, end) of memory
+		static void prefault(void *memory, std::size_t begin, std::size_t end) {
+#if defined(__linux__)
+			static const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+#else
+			const std::size_t pageSize = 4096;
+#endif
+			volatile char *bytes = static_cast<volatile char*>(memory);
+			for (std::size_t offset = detail::roundUp(begin, pageSize); offset < end; offset += pageSize) {
+				bytes[offset] = 0;
+			}
+		}
+
+#if defined(__linux__)
+		//Huge pages can only back 2 MiB aligned ranges, so map enough to find one and trim the rest
+		static void* mapHugePages(std::size_t bytes) {
+			const auto mappingBytes = detail::roundUp(bytes, HUGE_PAGE_SIZE);
+			void *memory = mmap(nullptr, mappingBytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (memory == MAP_FAILED) {
+				return nullptr;
+			}
+			char *mappingBegin = static_cast<char*>(memory);
+			char *alignedBegin = reinterpret_cast<char*>(detail::roundUp(reinterpret_cast<std::uintptr_t>(mappingBegin), HUGE_PAGE_SIZE));
+			if (alignedBegin != mappingBegin) {
+				munmap(mappingBegin, alignedBegin - mappingBegin);
+			}
+			munmap(alignedBegin + mappingBytes, (mappingBegin + HUGE_PAGE_SIZE) - alignedBegin);
+#if defined(MADV_HUGEPAGE)
+			//Only a hint, the kernel may have transparent huge pages disabled
+			madvise(alignedBegin, mappingBytes, MADV_HUGEPAGE);
+#endif
+			return alignedBegin;
+		}
+
+		static void unmapHugePages(void *memory, std::size_t bytes) {
+			munmap(memory, detail::roundUp(bytes, HUGE_PAGE_SIZE));
+		}
+#else
+		static void* mapHugePages(std::size_t bytes) {
+			return std::aligned_alloc(Alignment, detail::roundUp(bytes, Alignment));
+		}
+
+		static void unmapHugePages(void *memory, std::size_t) {
+			std::free(memory);
+		}
+#endif
+	};
+
+	//A monotonic (bump pointer) arena. Memory is handed out from large blocks and is only given back
+	//	all at once, by release() or the destructor
+	//The most recent allocation can be grown or shrunk in place, which is what lets a vector that was
+	//	the last thing allocated keep growing without copying
+	class arena {
+	public:
+		explicit arena(std::size_t blockSize = (std::size_t(1) << 16)) : nextBlockSize(std::max(blockSize, sizeof(Block))) {}
+
+		arena(const arena &) = delete;
+		arena& operator=(const arena &) = delete;
+
+		~arena() {
+			release();
+		}
+
+		void* allocate(std::size_t bytes, std::size_t alignment) {
+			char *memory = alignUp(top, alignment);
+			if (currentBlock == nullptr || memory + bytes > blockEnd) {
+				addBlock(bytes + alignment);
+				memory = alignUp(top, alignment);
+			}
+			lastAllocation = memory;
+			top = memory + bytes;
+			return memory;
+		}
+
+		//Resize the allocation at memory without moving it
+		//	Only possible for the most recent allocation, and only if the current block has room
+		bool expand(void *memory, std::size_t oldBytes, std::size_t newBytes) {
+			if (memory == nullptr || memory != lastAllocation || static_cast<char*>(memory) + oldBytes != top) {
+				return false;
+			}
+			if (newBytes > static_cast<std::size_t>(blockEnd - static_cast<char*>(memory))) {
+				return false;
+			}
+			top = static_cast<char*>(memory) + newBytes;
+			return true;
+		}
+
+		//Frees every block at once. Everything allocated from this arena is gone afterwards
+		void release() {
+			while (currentBlock != nullptr) {
+				Block *previous = currentBlock->previous;
+				std::free(currentBlock);
+				currentBlock = previous;
+			}
+			top = nullptr;
+			blockEnd = nullptr;
+			lastAllocation = nullptr;
+		}
+
+	private:
+		struct alignas(std::max_align_t) Block {
+			Block *previous;
+		};
+
+		Block *currentBlock{nullptr};
+		char *top{nullptr};
+		char *blockEnd{nullptr};
+		char *lastAllocation{nullptr};
+		std::size_t nextBlockSize;
+
+		static char* alignUp(char *memory, std::size_t alignment) {
+			const auto address = reinterpret_cast<std::uintptr_t>(memory);
+			return memory + ((alignment - address % alignment) % alignment);
+		}
+
+		void addBlock(std::size_t minimumBytes) {
+			//Blocks double in size so that the number of blocks stays logarithmic
+			const std::size_t blockSize = std::max(nextBlockSize, minimumBytes + sizeof(Block));
+			void *memory = std::malloc(blockSize);
+			if (memory == nullptr) {
+				throw std::bad_alloc();
+			}
+			Block *block = static_cast<Block*>(memory);
+			block->previous = currentBlock;
+			currentBlock = block;
+			top = reinterpret_cast<char*>(block + 1);
+			blockEnd = reinterpret_cast<char*>(block) + blockSize;
+			lastAllocation = nullptr;
+			nextBlockSize = blockSize * 2;
+		}
+	};
+
+	//Allocates from an arena. Deallocation does nothing, the arena releases everything at once
+	template<class Type>
+	class arena_allocator {
+	public:
+		using value_type 			= Type;
+		using size_type 			= std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference 			= Type&;
+		using const_reference = const Type&;
+		using pointer 				= Type*;
+		using const_pointer 	= const Type*;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		template<class Other>
+		struct rebind {
+			using other = arena_allocator<Other>;
+		};
+
+		arena_allocator(arena &source) : arenaPointer(&source) {}
+
+		template<class Other>
+		arena_allocator(const arena_allocator<Other> &other) : arenaPointer(other.arenaPointer) {}
+
+		pointer allocate(size_type count) {
+			if (count > max_size()) {
+				throw std::bad_array_new_length();
+			}
+			return static_cast<pointer>(arenaPointer->allocate(count * sizeof(Type), alignof(Type)));
+		}
+
+		void deallocate(pointer, size_type) {}
+
+		bool expand(pointer data, size_type oldCount, size_type newCount) {
+			return arenaPointer->expand(data, oldCount * sizeof(Type), newCount * sizeof(Type));
+		}
+
+		size_type max_size() const {
+			return std::numeric_limits<size_type>::max() / sizeof(Type);
+		}
+
+		friend bool operator==(const arena_allocator &left, const arena_allocator &right) {
+			return left.arenaPointer == right.arenaPointer;
+		}
+
+		friend bool operator!=(const arena_allocator &left, const arena_allocator &right) {
+			return !(left == right);
+		}
+
+	private:
+		template<class Other>
+		friend class arena_allocator;
+
+		arena *arenaPointer;
+	};
+
+#ifdef SANDSNIP3R_VECTOR_STATS
+	//Define SANDSNIP3R_VECTOR_STATS to have every vector count what its buffer management costs
+	//	Without it none of this exists and vectors carry no extra state
+	struct vector_stats {
+		//Calls to reallocate(), including growth that happened in place
+		uint64_t reallocations{0};
+		//Elements (and their bytes) moved to a new buffer
+		uint64_t elements_moved{0};
+		uint64_t bytes_moved{0};
+		//Largest buffer held
+		uint64_t peak_capacity_bytes{0};
+		//Unused capacity left behind by clear() and shrink_to_fit(), summed over every call
+		uint64_t wasted_bytes{0};
+	};
+
+	namespace detail {
+		struct global_vector_stats {
+			std::atomic<uint64_t> reallocations{0};
+			std::atomic<uint64_t> elementsMoved{0};
+			std::atomic<uint64_t> bytesMoved{0};
+			std::atomic<uint64_t> peakCapacityBytes{0};
+			std::atomic<uint64_t> wastedBytes{0};
+		};
+
+		inline global_vector_stats globalStats;
+	}
+
+	//Totals over every vector in the program
+	inline vector_stats global_vector_stats() {
+		vector_stats result;
+		result.reallocations = detail::globalStats.reallocations.load(std::memory_order_relaxed);
+		result.elements_moved = detail::globalStats.elementsMoved.load(std::memory_order_relaxed);
+		result.bytes_moved = detail::globalStats.bytesMoved.load(std::memory_order_relaxed);
+		result.peak_capacity_bytes = detail::globalStats.peakCapacityBytes.load(std::memory_order_relaxed);
+		result.wasted_bytes = detail::globalStats.wastedBytes.load(std::memory_order_relaxed);
+		return result;
+	}
+
+	inline void reset_global_vector_stats() {
+		detail::globalStats.reallocations.store(0, std::memory_order_relaxed);
+		detail::globalStats.elementsMoved.store(0, std::memory_order_relaxed);
+		detail::globalStats.bytesMoved.store(0, std::memory_order_relaxed);
+		detail::globalStats.peakCapacityBytes.store(0, std::memory_order_relaxed);
+		detail::globalStats.wastedBytes.store(0, std::memory_order_relaxed);
+	}
+#endif
+
+	//Tag for constructors that default-initialize their elements instead of value-initializing them
+	//	For trivial types that means leaving the memory uninitialized
+	struct default_init_t {
+		explicit default_init_t() = default;
+	};
+
+	inline constexpr default_init_t default_init{};
+
+	//Growth policies decide the capacity a vector grows to when it runs out of space
+	//	next_capacity(capacity, required, elementSize) returns a capacity of at least required
+	//	elements, where capacity is the current capacity and elementSize is sizeof(value_type)
+
+	//Grows by (roughly) the golden ratio
+	//Arguments state the the golden ratio is the most appropriate growth factor since it lets a
+	//	later allocation reuse the space freed by earlier ones
+	struct golden_ratio_growth {
+		template<class SizeType>
+		static constexpr SizeType next_capacity(SizeType capacity, SizeType required, std::size_t) {
+			//capacity * 1.625, rounded, without floating point math or overflowing the multiplication
+			const SizeType increase = capacity / 8 * 5 + ((capacity % 8) * 5 + 4) / 8;
+			return std::max(detail::saturatingAdd(capacity, increase), required);
+		}
+	};
+
+	struct doubling_growth {
+		template<class SizeType>
+		static constexpr SizeType next_capacity(SizeType capacity, SizeType required, std::size_t) {
+			return std::max(detail::saturatingAdd(capacity, capacity), required);
+		}
+	};
+
+	//The first allocation fills a whole cache line instead of holding a single element
+	template<class BasePolicy = golden_ratio_growth, std::size_t CacheLineSize = 64>
+	struct cache_line_first_growth {
+		template<class SizeType>
+		static constexpr SizeType next_capacity(SizeType capacity, SizeType required, std::size_t elementSize) {
+			if (capacity == 0) {
+				const SizeType perCacheLine = std::max<SizeType>(CacheLineSize / elementSize, 1);
+				return std::max(perCacheLine, required);
+			}
+			return BasePolicy::next_capacity(capacity, required, elementSize);
+		}
+	};
+
+	//What the containers grow with unless told otherwise. Golden ratio growth alone starts out with
+	//	1, 2, 3, 5 elements and reallocates at every one of them, so the first allocation fills a cache line
+	using default_growth = cache_line_first_growth<golden_ratio_growth>;
+
+	//Once a buffer is at least Threshold bytes, its size is rounded up to whole pages
+	template<class BasePolicy = golden_ratio_growth, std::size_t Threshold = (std::size_t(1) << 16), std::size_t PageSize = 4096>
+	struct page_aligned_growth {
+		template<class SizeType>
+		static constexpr SizeType next_capacity(SizeType capacity, SizeType required, std::size_t elementSize) {
+			const SizeType newCapacity = BasePolicy::next_capacity(capacity, required, elementSize);
+			const std::size_t bytes = newCapacity * elementSize;
+			if (bytes < Threshold || newCapacity > std::numeric_limits<std::size_t>::max() / elementSize - PageSize) {
+				return newCapacity;
+			}
+			return detail::roundUp(bytes, PageSize) / elementSize;
+		}
+	};
+
+	//Rounds every allocation up to the size malloc would actually hand out for it, so no usable bytes
+	//	are wasted. The size classes modelled are glibc's: 16 byte steps with 8 bytes of chunk header, and
+	//	page granular mmap chunks with 16 bytes of header above MmapThreshold
+	template<class BasePolicy = golden_ratio_growth, std::size_t MmapThreshold = (std::size_t(128) << 10), std::size_t PageSize = 4096>
+	struct size_class_growth {
+		template<class SizeType>
+		static constexpr SizeType next_capacity(SizeType capacity, SizeType required, std::size_t elementSize) {
+			const SizeType newCapacity = BasePolicy::next_capacity(capacity, required, elementSize);
+			if (newCapacity > std::numeric_limits<std::size_t>::max() / elementSize - PageSize) {
+				return newCapacity;
+			}
+			const std::size_t bytes = newCapacity * elementSize;
+			std::size_t usableBytes;
+			if (bytes + 8 >= MmapThreshold) {
+				usableBytes = detail::roundUp(bytes + 16, PageSize) - 16;
+			} else {
+				usableBytes = std::max<std::size_t>(detail::roundUp(bytes + 8, 16), 32) - 8;
+			}
+			return usableBytes / elementSize;
+		}
+	};
+
+	namespace detail {
+		//Storage policies say whether a vector keeps a buffer inside the object itself. vector only looks at
+		//	INLINE_CAPACITY at compile time, so a plain vector pays nothing for small_vector's inline storage
+		struct heap_storage {
+			static constexpr std::size_t INLINE_CAPACITY = 0;
+		};
+
+		template<class Type, std::size_t N>
+		struct inline_storage {
+			static constexpr std::size_t INLINE_CAPACITY = N;
+			alignas(Type) unsigned char inlineBytes[N * sizeof(Type)];
+		};
+	}
+
+	//Storage is detail::heap_storage for everything but small_vector
+	template<class Type, class Allocator = std::allocator<Type>, class GrowthPolicy = default_growth, class Storage = detail::heap_storage>
+	class vector : private Storage {
 	public:
 		using allocator_type 	= Allocator;
 		using value_type 			= typename Allocator::value_type;
@@ -21,8 +1124,11 @@ namespace sandsnip3r {
 		using pointer 				= typename Allocator::pointer;
 		using const_pointer 	= typename Allocator::const_pointer;
 
+		class const_iterator;
+
 		class iterator {
 		friend class vector;
+		friend class const_iterator;
 		public:
 			using value_type 				= typename Allocator::value_type;
 			using size_type 				= typename Allocator::size_type;
@@ -115,7 +1221,7 @@ namespace sandsnip3r {
 			}
 
 			iterator& operator-=(size_type n) {
-				iteratorPointer += n;
+				iteratorPointer -= n;
 				return *this;
 			}
 
@@ -149,6 +1255,7 @@ namespace sandsnip3r {
 		public:
 			const_iterator() = default;
 			const_iterator(const const_iterator &it) : iteratorPointer(it.iteratorPointer) {}
+			const_iterator(const iterator &it) : iteratorPointer(it.iteratorPointer) {}
 			const_iterator& operator=(const const_iterator &it) {
 				if (this != &it) {
 					this->iteratorPointer = it.iteratorPointer;
@@ -157,9 +1264,7 @@ namespace sandsnip3r {
 			}
 
 			const_iterator& operator=(const iterator &it) {
-				if (this != &it) {
-					this->iteratorPointer = it.iteratorPointer;
-				}
+				this->iteratorPointer = it.iteratorPointer;
 				return *this;
 			}
 
@@ -233,7 +1338,7 @@ namespace sandsnip3r {
 			}
 
 			const_iterator& operator-=(size_type n) {
-				iteratorPointer += n;
+				iteratorPointer -= n;
 				return *this;
 			}
 
@@ -252,30 +1357,170 @@ namespace sandsnip3r {
 		using reverse_iterator 				= std::reverse_iterator<iterator>;
 		using const_reverse_iterator 	= std::reverse_iterator<const_iterator>;
 
-	private:
-		using allocatorTraits = std::allocator_traits<allocator_type>;
-		allocator_type vectorAllocator;
-		pointer dataBegin{nullptr};
-		pointer dataEnd{nullptr};
-		pointer containerEnd{nullptr};
+	protected:
+		using allocatorTraits = std::allocator_traits<allocator_type>;
+		allocator_type vectorAllocator;
+		pointer dataBegin{nullptr};
+		pointer dataEnd{nullptr};
+		pointer containerEnd{nullptr};
+
+		static constexpr bool hasInlineStorage = (Storage::INLINE_CAPACITY > 0);
+
+		pointer inlineData() {
+			if constexpr (hasInlineStorage) {
+				return reinterpret_cast<pointer>(Storage::inlineBytes);
+			} else {
+				return nullptr;
+			}
+		}
+
+		//Inline storage doesn't come from the allocator. It is never deallocated, grown in place or given to
+		//	another vector
+		bool isInlineStorage(pointer data) const {
+			if constexpr (hasInlineStorage) {
+				return data == reinterpret_cast<const_pointer>(Storage::inlineBytes);
+			} else {
+				return false;
+			}
+		}
+
+		//Called on a vector whose buffer was just taken by another vector, and to set up inline storage
+		void resetStorage() {
+			dataBegin = inlineData();
+			dataEnd = dataBegin;
+			containerEnd = dataBegin + Storage::INLINE_CAPACITY;
+		}
+
+#ifdef SANDSNIP3R_VECTOR_STATS
+		vector_stats vectorStats;
+#endif
+
+		//Both of these compile to nothing unless SANDSNIP3R_VECTOR_STATS is defined
+		void recordReallocation(size_type elementsMoved) {
+#ifdef SANDSNIP3R_VECTOR_STATS
+			const uint64_t bytesMoved = elementsMoved * sizeof(value_type);
+			const uint64_t capacityBytes = capacity() * sizeof(value_type);
+			++vectorStats.reallocations;
+			vectorStats.elements_moved += elementsMoved;
+			vectorStats.bytes_moved += bytesMoved;
+			vectorStats.peak_capacity_bytes = std::max(vectorStats.peak_capacity_bytes, capacityBytes);
+			detail::globalStats.reallocations.fetch_add(1, std::memory_order_relaxed);
+			detail::globalStats.elementsMoved.fetch_add(elementsMoved, std::memory_order_relaxed);
+			detail::globalStats.bytesMoved.fetch_add(bytesMoved, std::memory_order_relaxed);
+			auto peak = detail::globalStats.peakCapacityBytes.load(std::memory_order_relaxed);
+			while (peak < capacityBytes && !detail::globalStats.peakCapacityBytes.compare_exchange_weak(peak, capacityBytes, std::memory_order_relaxed)) {}
+#endif
+		}
+
+		void recordWaste() {
+#ifdef SANDSNIP3R_VECTOR_STATS
+			const uint64_t wastedBytes = (capacity() - size()) * sizeof(value_type);
+			vectorStats.wasted_bytes += wastedBytes;
+			detail::globalStats.wastedBytes.fetch_add(wastedBytes, std::memory_order_relaxed);
+#endif
+		}
+
+		bool usesInlineStorage() const {
+			return isInlineStorage(dataBegin);
+		}
 
 		pointer allocate(size_type capacity) {
 			return allocatorTraits::allocate(vectorAllocator, capacity);
 		}
 
 		void deallocate(pointer data, size_type capacity) {
+			if (isInlineStorage(data)) {
+				return;
+			}
 			allocatorTraits::deallocate(vectorAllocator, data, capacity);	
 		}
 
-		void reallocateIfNecessary() {
-			if (dataEnd == containerEnd) {
-				//Need to reallocate to make space
-				//Arguments state the the golden ratio is the most appropriate growth factor
-				const auto GROWTH_FACTOR = 1.618;
-				auto cap = capacity();
-				size_type newCapacity = (cap == 0 ? 1 : std::llround(cap * GROWTH_FACTOR));
-				reallocate(newCapacity);
+		//Move assignment, including from inline storage. Moving inline elements may throw, so derived
+		//	containers call this with their own exception specification
+		void moveAssign(vector &other) {
+			//Destroy everything in this container
+			this->resizeDown(0);
+
+			if (other.usesInlineStorage()) {
+				//Inline storage can't change owners
+				//keep current and move-construct all elements in-place
+				this->moveElementsFrom(other);
+			} else if (typename allocatorTraits::propagate_on_container_move_assignment()) {
+				//Release our buffer with the allocator that allocated it
+				this->deallocate(this->dataBegin, this->capacity());
+				//Allocator is propigated
+				this->vectorAllocator = other.vectorAllocator;
+				//Take ownership of everything from the other vector
+				this->stealStorage(other);
+			} else if (vectorAllocator != other.vectorAllocator) {
+				//Allocators are different and dont propigate
+				//keep current and move-construct all elements in-place
+				this->moveElementsFrom(other);
+			} else {
+				//Allocators are equal
+				this->deallocate(this->dataBegin, this->capacity());
+				//Take ownership of everything from the other vector
+				this->stealStorage(other);
+			}
+		}
+
+		//Take ownership of other's buffer, which must not be inline storage
+		void stealStorage(vector &other) {
+			dataBegin = other.dataBegin;
+			dataEnd = other.dataEnd;
+			containerEnd = other.containerEnd;
+			other.resetStorage();
+		}
+
+		//Move-construct other's elements into this vector's buffer, which must hold no elements
+		void moveElementsFrom(vector &other) {
+			auto otherSize = other.size();
+			reallocateToNewSizeIfNecessary(otherSize);
+			for (size_type i=0; i<otherSize; ++i) {
+				allocatorTraits::construct(vectorAllocator, dataEnd, std::move(other[i]));
+				++dataEnd;
+			}
+		}
+
+		//Constructs a new last element in a full vector. args may refer to one of our own elements, so
+		//	they are only read while the current buffer is still alive: either the allocator extends the
+		//	buffer in place or the element is constructed in the new buffer before anything moves
+		template<class... Args>
+		reference growAndEmplaceBack(Args&&... args) {
+			const size_type dataSize = size();
+			if constexpr (detail::has_reallocate<allocator_type>::value && is_trivially_relocatable_v<value_type>) {
+				if (dataBegin != nullptr && !usesInlineStorage()) {
+					//The allocator frees the old buffer itself, so the element is built before it goes
+					value_type element(std::forward<Args>(args)...);
+					reallocate(nextCapacity(dataSize + 1));
+					allocatorTraits::construct(vectorAllocator, dataEnd, std::move(element));
+					return *(dataEnd++);
+				}
+			}
+			if (dataSize < max_size() && expandInPlace(std::min(nextCapacity(dataSize + 1), max_size()))) {
+				allocatorTraits::construct(vectorAllocator, dataEnd, std::forward<Args>(args)...);
+				return *(dataEnd++);
+			}
+			insertElements(dataSize, 1, [&](pointer destination) {
+				allocatorTraits::construct(vectorAllocator, destination, std::forward<Args>(args)...);
+			});
+			return back();
+		}
+
+		//Has the allocator extend the current heap buffer to newCapacity without moving it, if it can
+		bool expandInPlace(size_type newCapacity) {
+			if constexpr (detail::has_expand<allocator_type>::value) {
+				if (dataBegin != nullptr && !usesInlineStorage() && vectorAllocator.expand(dataBegin, capacity(), newCapacity)) {
+					containerEnd = dataBegin + newCapacity;
+					recordReallocation(0);
+					return true;
+				}
 			}
+			return false;
+		}
+
+		size_type nextCapacity(size_type required) const {
+			return GrowthPolicy::next_capacity(capacity(), required, sizeof(value_type));
 		}
 
 		void reallocateToNewSizeIfNecessary(size_type newCapacity) {
@@ -289,16 +1534,31 @@ namespace sandsnip3r {
 			if (newCapacity > max_size()) {
 				throw std::length_error("vector::reallocate() newCapacity (which is "+std::to_string(newCapacity)+") > max_size (which is "+std::to_string(max_size())+")");
 			}
+			if (dataBegin != nullptr && !usesInlineStorage()) {
+				const auto dataSize = size();
+				if constexpr (detail::has_reallocate<allocator_type>::value && is_trivially_relocatable_v<value_type>) {
+					//The allocator can move the bytes for us, possibly without copying them
+					pointer newDataBegin = vectorAllocator.reallocate(dataBegin, capacity(), newCapacity);
+					const bool moved = (newDataBegin != dataBegin);
+					dataBegin = newDataBegin;
+					dataEnd = dataBegin + dataSize;
+					containerEnd = dataBegin + newCapacity;
+					recordReallocation(moved ? dataSize : 0);
+					return;
+				} else if (expandInPlace(newCapacity)) {
+					//Grew in place, nothing needs to move
+					return;
+				}
+			}
 			pointer newDataBegin = allocate(newCapacity);
-			pointer newDataEnd = newDataBegin;
-			auto it = dataBegin;
-			//Move construct new elements into place
-			//	also destroy previous
-			while (it != dataEnd) {
-				allocatorTraits::construct(vectorAllocator, newDataEnd, std::move(*it));
-				allocatorTraits::destroy(vectorAllocator, it);
-				++it;
-				++newDataEnd;
+			//Move elements into place and destroy the previous ones
+			//	Copies are made instead if moving could throw, then nothing has changed if one fails
+			pointer newDataEnd;
+			try {
+				newDataEnd = detail::relocate(vectorAllocator, dataBegin, dataEnd, newDataBegin);
+			} catch (...) {
+				allocatorTraits::deallocate(vectorAllocator, newDataBegin, newCapacity);
+				throw;
 			}
 			//Deallocate previous memory
 			deallocate(dataBegin, containerEnd - dataBegin);
@@ -306,14 +1566,209 @@ namespace sandsnip3r {
 			dataBegin = newDataBegin;
 			dataEnd = newDataEnd;
 			containerEnd = dataBegin + newCapacity;
+			recordReallocation(size());
 		}
 
-		void resizeDown(size_type count) {
-			int distance = size() - count;
-			for (int i=0; i<distance; ++i) {
-				--dataEnd;
-				allocatorTraits::destroy(vectorAllocator, dataEnd);
+		//Makes room for count elements at index and fills it by calling constructElements(destination),
+		//	which must construct exactly count elements starting at destination or construct none and throw
+		//If the vector has to grow, the new elements and the old ones are placed straight into their final
+		//	positions in the new buffer. Otherwise the tail is shifted back to open a gap
+		template<class ConstructElements>
+		iterator insertElements(size_type index, size_type count, ConstructElements constructElements) {
+			const size_type dataSize = size();
+			if (count > capacity() - dataSize) {
+				if (count > max_size() - dataSize) {
+					throw std::length_error("vector::insert() size (which is "+std::to_string(dataSize)+") + count (which is "+std::to_string(count)+") > max_size (which is "+std::to_string(max_size())+")");
+				}
+				const size_type newCapacity = std::min(nextCapacity(dataSize + count), max_size());
+				pointer newDataBegin = allocate(newCapacity);
+				try {
+					detail::relocateAroundGap(vectorAllocator, dataBegin, dataBegin + index, dataEnd, newDataBegin, count, constructElements);
+				} catch (...) {
+					allocatorTraits::deallocate(vectorAllocator, newDataBegin, newCapacity);
+					throw;
+				}
+				deallocate(dataBegin, capacity());
+				dataBegin = newDataBegin;
+				dataEnd = newDataBegin + dataSize + count;
+				containerEnd = newDataBegin + newCapacity;
+				recordReallocation(dataSize);
+			} else if (count > 0) {
+				detail::insertInPlace(dataBegin + index, dataEnd, count, constructElements);
+				dataEnd += count;
+			}
+			return begin() + index;
+		}
+
+		//Constructs count elements at destination, calling constructElement(element, index) for each. Either
+		//	all of them are constructed or, if one throws, none are left behind
+		template<class ConstructElement>
+		void constructElements(pointer destination, size_type count, ConstructElement constructElement) {
+#ifdef SANDSNIP3R_VECTOR_PARALLEL
+			if (detail::isParallel(count)) {
+				detail::parallelFor(count, [&](std::size_t begin, std::size_t end) {
+					constructChunk(destination, begin, end, constructElement);
+				}, [&](std::size_t begin, std::size_t end) {
+					destroyElements(destination + begin, destination + end);
+				});
+				return;
+			}
+#endif
+			constructChunk(destination, 0, count, constructElement);
+		}
+
+		template<class ConstructElement>
+		void constructChunk(pointer destination, size_type begin, size_type end, ConstructElement &constructElement) {
+			size_type constructed = begin;
+			try {
+				for (; constructed<end; ++constructed) {
+					constructElement(destination + constructed, constructed);
+				}
+			} catch (...) {
+				destroyElements(destination + begin, destination + constructed);
+				throw;
+			}
+		}
+
+		void constructCopies(pointer destination, size_type count, const value_type &value) {
+			constructElements(destination, count, [&](pointer element, size_type) {
+				allocatorTraits::construct(vectorAllocator, element, value);
+			});
+		}
+
+		//Ranges over contiguous elements of our own type, which can be copied as bytes if that is all a copy does
+		template<class InputIt>
+		static constexpr bool isBytewiseCopyable = std::is_trivially_copyable<value_type>::value && std::is_pointer<pointer>::value &&
+		                                           !detail::has_construct<allocator_type, const value_type&>::value &&
+		                                           (std::is_same<InputIt, value_type*>::value || std::is_same<InputIt, const value_type*>::value ||
+		                                            std::is_same<InputIt, iterator>::value || std::is_same<InputIt, const_iterator>::value);
+
+		template<class InputIt>
+		void constructRange(pointer destination, InputIt first, size_type count) {
+			if constexpr (isBytewiseCopyable<InputIt>) {
+				if (count > 0) {
+					detail::copyBytes(destination, std::addressof(*first), count);
+				}
+			} else if constexpr (std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				constructElements(destination, count, [&](pointer element, size_type index) {
+					allocatorTraits::construct(vectorAllocator, element, first[index]);
+				});
+			} else {
+				size_type constructed = 0;
+				try {
+					for (; constructed<count; ++constructed, ++first) {
+						allocatorTraits::construct(vectorAllocator, destination + constructed, *first);
+					}
+				} catch (...) {
+					destroyElements(destination, destination + constructed);
+					throw;
+				}
+			}
+		}
+
+		//Grows to count elements, value-initializing the new ones
+		void growValueInitialized(size_type count) {
+			reallocateToNewSizeIfNecessary(count);
+			constructElements(dataEnd, count - size(), [&](pointer element, size_type) {
+				allocatorTraits::construct(vectorAllocator, element);
+			});
+			dataEnd = dataBegin + count;
+		}
+
+		//Makes room for count elements in a vector holding none, without the relocation reallocate() would do
+		void reserveEmpty(size_type count) {
+			if (capacity() < count) {
+				if (count > max_size()) {
+					throw std::length_error("vector::reallocate() newCapacity (which is "+std::to_string(count)+") > max_size (which is "+std::to_string(max_size())+")");
+				}
+				pointer newDataBegin = allocate(count);
+				deallocate(dataBegin, capacity());
+				dataBegin = dataEnd = newDataBegin;
+				containerEnd = dataBegin + count;
+				recordReallocation(0);
+			}
+		}
+
+		//Appends a single pass range, growing geometrically since its length isn't known
+		template<class InputIt>
+		void appendInputRange(InputIt first, InputIt last) {
+			for (; first != last; ++first) {
+				emplace_back(*first);
+			}
+		}
+
+		//Replaces the elements with the count starting at first. Elements we already have are copy-assigned
+		//	over, so whatever they own (a string's buffer, say) is reused, and only the difference is
+		//	constructed or destroyed. A buffer that is too small has nothing worth keeping
+		template<class ForwardIt>
+		void assignElements(ForwardIt first, size_type count) {
+			if (count > capacity()) {
+				resizeDown(0);
+				reserveEmpty(count);
+				constructRange(dataBegin, first, count);
+			} else if constexpr (isBytewiseCopyable<ForwardIt>) {
+				if (count > 0) {
+					detail::copyBytes(dataBegin, std::addressof(*first), count);
+				}
+			} else {
+				detail::assignOver(vectorAllocator, dataBegin, size(), first, count, [&](pointer destination, ForwardIt source, size_type sourceCount) {
+					constructRange(destination, source, sourceCount);
+				});
+			}
+			dataEnd = dataBegin + count;
+		}
+
+		//Constructors fill a freshly allocated buffer through this, since the destructor won't run to
+		//	release it if filling throws
+		template<class Fill>
+		void initialize(size_type count, Fill fill) {
+			reserveEmpty(count);
+			try {
+				fill();
+			} catch (...) {
+				resizeDown(0);
+				deallocate(dataBegin, capacity());
+				dataBegin = dataEnd = containerEnd = nullptr;
+				throw;
+			}
+		}
+
+		void destroyElements(pointer first, pointer last) {
+			if constexpr (!std::is_trivially_destructible<value_type>::value) {
+				for (; first != last; ++first) {
+					allocatorTraits::destroy(vectorAllocator, first);
+				}
+			}
+		}
+
+		bool isElement(const value_type &value) const {
+			std::less<const value_type*> less;
+			const value_type *address = std::addressof(value);
+			return !less(address, dataBegin) && less(address, dataEnd);
+		}
+
+		//Grows to count elements, default-initializing the new ones
+		void growDefaultInitialized(size_type count) {
+			reallocateToNewSizeIfNecessary(count);
+			pointer newDataEnd = dataBegin + count;
+			if constexpr (!std::is_trivially_default_constructible<value_type>::value) {
+				pointer current = dataEnd;
+				try {
+					for (; current != newDataEnd; ++current) {
+						::new (static_cast<void*>(current)) value_type;
+					}
+				} catch (...) {
+					destroyElements(dataEnd, current);
+					throw;
+				}
 			}
+			dataEnd = newDataEnd;
+		}
+
+		void resizeDown(size_type count) {
+			pointer newDataEnd = dataBegin + count;
+			destroyElements(newDataEnd, dataEnd);
+			dataEnd = newDataEnd;
 		}
 
 	public:
@@ -322,21 +1777,24 @@ namespace sandsnip3r {
 		explicit vector(const Allocator& alloc) : vectorAllocator(alloc) {}
 
 		explicit vector(size_type count, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
-			reallocate(count);
-			for (size_type i=0; i<count; ++i) {
-				//Fill with (count) default constructed elements
-				allocatorTraits::construct(vectorAllocator, dataEnd);
-				++dataEnd;
-			}
+			initialize(count, [&]() {
+				growValueInitialized(count);
+			});
+		}
+
+		//Elements are default-initialized (not through the allocator), for buffers that are about to be
+		//	overwritten anyway
+		vector(size_type count, default_init_t, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
+			initialize(count, [&]() {
+				growDefaultInitialized(count);
+			});
 		}
 
 		vector(size_type count, const Type &value, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
-			reallocate(count);
-			for (size_type i=0; i<count; ++i) {
-				//Fill with (count) 'value' elements
-				allocatorTraits::construct(vectorAllocator, dataEnd, value);
-				++dataEnd;
-			}
+			initialize(count, [&]() {
+				constructCopies(dataBegin, count, value);
+				dataEnd = dataBegin + count;
+			});
 		}
 
 		template<class InputIt, typename = std::enable_if_t<
@@ -347,58 +1805,49 @@ namespace sandsnip3r {
 														InputIt
 													>>
 		vector(InputIt first, InputIt last, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
-			reallocate(last-first);
-			while (first != last) {
-				//Fill with elements in range
-				emplace_back(*first);
-				++first;
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				//Size is known up front, so allocate once
+				const size_type count = std::distance(first, last);
+				initialize(count, [&]() {
+					constructRange(dataBegin, first, count);
+					dataEnd = dataBegin + count;
+				});
+			} else {
+				initialize(0, [&]() {
+					appendInputRange(first, last);
+				});
 			}
 		}
 
-		vector(std::initializer_list<Type> ilist, const Allocator &alloc = Allocator()) : vectorAllocator(alloc) {
-			const size_type length = std::distance(ilist.begin(), ilist.end());
-			reallocate(length);
-			for (auto it=ilist.begin(), end=ilist.end(); it!=end; ++it) {
-				emplace_back(*it);
-			}
-		}
+		vector(std::initializer_list<Type> ilist, const Allocator &alloc = Allocator()) : vector(ilist.begin(), ilist.end(), alloc) {}
 
-		vector(const vector &other) : vectorAllocator(allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {
-			auto otherVectorSize = other.size();
-			//Allocate for higher capacity
-			reallocate(otherVectorSize);
-			//Copy construct all elements into this list
-			dataEnd = dataBegin;
-			for (size_type i=0; i<otherVectorSize; ++i) {
-				allocatorTraits::construct(vectorAllocator, dataEnd, other[i]);
-				++dataEnd;
-			}
-		}
+		vector(const vector &other) : vector(other, allocatorTraits::select_on_container_copy_construction(other.get_allocator())) {}
 
 		vector(const vector &other, const Allocator &alloc) : vectorAllocator(alloc) {
-			auto otherVectorSize = other.size();
-			//Allocate for higher capacity
-			this->reallocate(otherVectorSize);
-			//Copy construct all elements into this list
-			this->dataEnd = this->dataBegin;
-			for (size_type i=0; i<otherVectorSize; ++i) {
-				allocatorTraits::construct(this->vectorAllocator, this->dataEnd, other[i]);
-				++this->dataEnd;
-			}
+			const size_type otherVectorSize = other.size();
+			initialize(otherVectorSize, [&]() {
+				//Copy construct all elements into this list
+				constructRange(dataBegin, other.dataBegin, otherVectorSize);
+				dataEnd = dataBegin + otherVectorSize;
+			});
 		}
 
-		vector(vector &&other) : vectorAllocator(std::move(other.vectorAllocator)) {
-			std::swap(dataBegin, other.dataBegin);
-			std::swap(dataEnd, other.dataEnd);
-			std::swap(containerEnd, other.containerEnd);
+		//Containers with inline storage (like small_vector) inherit privately, so other's buffer always
+		//	came from the allocator and can be taken over
+		vector(vector &&other) noexcept : vectorAllocator(std::move(other.vectorAllocator)) {
+			static_assert(!hasInlineStorage, "inline storage can't be taken over, small_vector moves its elements instead");
 			//Take ownership of everything from the other vector
+			stealStorage(other);
 		}
 
 		vector(vector &&other, const Allocator &alloc) : vectorAllocator(alloc) {
-			std::swap(dataBegin, other.dataBegin);
-			std::swap(dataEnd, other.dataEnd);
-			std::swap(containerEnd, other.containerEnd);
-			//Take ownership of everything from the other vector
+			if (other.usesInlineStorage() || vectorAllocator != other.vectorAllocator) {
+				//Memory from another allocator can't be taken over
+				moveElementsFrom(other);
+			} else {
+				//Take ownership of everything from the other vector
+				stealStorage(other);
+			}
 		}
 
 		virtual ~vector() {
@@ -409,87 +1858,76 @@ namespace sandsnip3r {
 
 		vector& operator=(const vector &other) {
 			if (&other != this) {
-				//Destroy everything in this container
-				this->resizeDown(0);
-
 				if (typename allocatorTraits::propagate_on_container_copy_assignment()) {
+					if (this->vectorAllocator != other.vectorAllocator) {
+						//Our buffer belongs to the allocator we are about to replace
+						this->resizeDown(0);
+						this->deallocate(this->dataBegin, this->capacity());
+						this->resetStorage();
+					}
 					this->vectorAllocator = other.vectorAllocator;
-				} else if (this->vectorAllocator != other.vectorAllocator) {
-					//Allocators dont propigate and are different
-					//use current to deallocate
-					this->deallocate(this->dataBegin, this->capacity());
-					//Grab other allocator
-					this->vectorAllocator = other.vectorAllocator;
-				} else {
-					//Allocators are the same, no need to copy allocators
-				}
-
-				//Allocate for higher capacity if neccessary
-				//	if 'other' has a smaller capacity, we dont reduce ours
-				//	we only allocate up to other's size
-				this->reallocateToNewSizeIfNecessary(other.size());
-				//Copy construct all elements into this list
-				dataEnd = dataBegin;
-				for (size_type i=0; i<other.size(); ++i) {
-					allocatorTraits::construct(vectorAllocator, dataEnd, other[i]);
-					++dataEnd;
 				}
+				//Assign over the elements we already have, so they can keep what they own
+				assignElements(other.dataBegin, other.size());
 			}
 			return *this;
 		}
 
-		vector& operator=(vector &&other) {
+		vector& operator=(vector &&other) noexcept(allocatorTraits::propagate_on_container_move_assignment::value || allocatorTraits::is_always_equal::value) {
 			if (&other != this) {
-				//Destroy everything in this container
-				this->resizeDown(0);
+				moveAssign(other);
+			}
+			return *this;
+		}
 
-				if (typename allocatorTraits::propagate_on_container_move_assignment()) {
-					//Allocator is propigated
-					this->vectorAllocator = other.vectorAllocator;
-					//Take ownership of everything from the other vector
-					this->dataBegin = std::move(other.dataBegin);
-					other.dataBegin = nullptr;
-					this->dataEnd = std::move(other.dataEnd);
-					other.dataEnd = nullptr;
-					this->containerEnd = std::move(other.containerEnd);
-					other.containerEnd = nullptr;
-				} else if (vectorAllocator != other.vectorAllocator) {
-					//Allocators are different and dont propigate
-					//keep current and move-construct all elements in-place
-					auto otherSize = other.size();
-					this->reallocateToNewSizeIfNecessary(otherSize);
-					this->dataEnd = this->dataBegin;
-					for (size_type i=0; i<otherSize; ++i) {
-						allocatorTraits::construct(this->vectorAllocator, this->dataEnd, std::move(other[i]));
-						++this->dataEnd;
-					}
+		vector& operator=(std::initializer_list<value_type> ilist) {
+			assign(ilist.begin(), ilist.end());
+			return *this;
+		}
+
+		void assign(size_type count, const value_type &value) {
+			if (count > capacity()) {
+				if (isElement(value)) {
+					//Clearing would destroy value
+					value_type copy(value);
+					assign(count, copy);
+					return;
+				}
+				resizeDown(0);
+				reserveEmpty(count);
+				constructCopies(dataBegin, count, value);
+			} else {
+				const size_type common = std::min(size(), count);
+				std::fill(dataBegin, dataBegin + common, value);
+				if (count > common) {
+					constructCopies(dataEnd, count - common, value);
 				} else {
-					//Allocators are equal
-					//Take ownership of everything from the other vector
-					this->dataBegin = std::move(other.dataBegin);
-					other.dataBegin = nullptr;
-					this->dataEnd = std::move(other.dataEnd);
-					other.dataEnd = nullptr;
-					this->containerEnd = std::move(other.containerEnd);
-					other.containerEnd = nullptr;
+					resizeDown(count);
 				}
 			}
-			return *this;
+			dataEnd = dataBegin + count;
 		}
 
-		vector& operator=(std::initializer_list<value_type> ilist) {
-			//Destroy everything in this container
-			this->resizeDown(0);
-			//Reallocate if this is larger than our current container
-			const size_type length = std::distance(ilist.begin(), ilist.end());
-			reallocateToNewSizeIfNecessary(length);
-			for (auto it=ilist.begin(), end=ilist.end(); it!=end; ++it) {
-				emplace_back(*it);
+		//The range must not be part of this vector
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		void assign(InputIt first, InputIt last) {
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				assignElements(first, std::distance(first, last));
+			} else {
+				resizeDown(0);
+				appendInputRange(first, last);
 			}
-			return *this;
 		}
 
-		//assign
+		void assign(std::initializer_list<value_type> ilist) {
+			assign(ilist.begin(), ilist.end());
+		}
 
 		allocator_type get_allocator() const {
 			return vectorAllocator;
@@ -611,47 +2049,195 @@ namespace sandsnip3r {
 
 		void shrink_to_fit() {
 			auto dataSize = size();
-			if (dataSize < capacity()) {
+			if (dataSize < capacity() && !usesInlineStorage()) {
 				reallocate(dataSize);
 			}
+			recordWaste();
 		}
 
 		void clear() {
 			resizeDown(0);
+			recordWaste();
+		}
+
+#ifdef SANDSNIP3R_VECTOR_STATS
+		const vector_stats& stats() const {
+			return vectorStats;
+		}
+#endif
+
+		iterator insert(const_iterator pos, const value_type &value) {
+			return insert(pos, 1, value);
+		}
+
+		iterator insert(const_iterator pos, value_type &&value) {
+			return emplace(pos, std::move(value));
+		}
+
+		iterator insert(const_iterator pos, size_type count, const value_type &value) {
+			const size_type index = pos - cbegin();
+			if (count <= capacity() - size() && isElement(value)) {
+				//Shifting the tail would move value out from under us
+				value_type copy(value);
+				return insert(cbegin() + index, count, copy);
+			}
+			return insertElements(index, count, [&](pointer destination) {
+				constructCopies(destination, count, value);
+			});
+		}
+
+		template<class InputIt, typename = std::enable_if_t<
+														std::is_base_of<
+															std::input_iterator_tag,
+															typename std::iterator_traits<InputIt>::iterator_category
+														>::value,
+														InputIt
+													>>
+		iterator insert(const_iterator pos, InputIt first, InputIt last) {
+			const size_type index = pos - cbegin();
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				//Size is known up front, so make room once
+				const size_type count = std::distance(first, last);
+				return insertElements(index, count, [&](pointer destination) {
+					constructRange(destination, first, count);
+				});
+			} else {
+				//Single pass range, append everything and then rotate it into place
+				const size_type oldSize = size();
+				appendInputRange(first, last);
+				std::rotate(dataBegin + index, dataBegin + oldSize, dataEnd);
+				return begin() + index;
+			}
 		}
 
-		// iterator insert(const_iterator pos, const value_type& value)
-		// iterator insert(const_iterator pos, T&& value)
-		// iterator insert(const_iterator pos, size_type count, const T& value)
-		// template< class InputIt >
-		// iterator insert(const_iterator pos, InputIt first, InputIt last)
-		// iterator insert(const_iterator pos, std::initializer_list<T> ilist)
+		iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+			return insert(pos, ilist.begin(), ilist.end());
+		}
+
+		template<class... Args>
+		iterator emplace(const_iterator pos, Args&&... args) {
+			const size_type index = pos - cbegin();
+			if (index == size()) {
+				emplace_back(std::forward<Args>(args)...);
+				return begin() + index;
+			}
+			if (dataEnd == containerEnd) {
+				//The element is constructed in the new buffer before anything moves, so args stay valid
+				return insertElements(index, 1, [&](pointer destination) {
+					allocatorTraits::construct(vectorAllocator, destination, std::forward<Args>(args)...);
+				});
+			}
+			//args may refer to an element that is about to be shifted
+			value_type temp(std::forward<Args>(args)...);
+			return insertElements(index, 1, [&](pointer destination) {
+				allocatorTraits::construct(vectorAllocator, destination, std::move(temp));
+			});
+		}
+
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
 
-		// template< class... Args > 
-		// iterator emplace(const_iterator pos, Args&&... args)
+		iterator erase(const_iterator first, const_iterator last) {
+			pointer eraseBegin = dataBegin + (first - cbegin());
+			pointer eraseEnd = dataBegin + (last - cbegin());
+			if (eraseBegin != eraseEnd) {
+				if constexpr (is_trivially_relocatable_v<value_type>) {
+					//Destroy the erased elements and slide the tail down over them
+					destroyElements(eraseBegin, eraseEnd);
+					std::memmove(static_cast<void*>(eraseBegin), static_cast<const void*>(eraseEnd), (dataEnd - eraseEnd) * sizeof(value_type));
+					dataEnd -= (eraseEnd - eraseBegin);
+				} else {
+					//Move the tail down and destroy whatever is left over at the end
+					pointer newDataEnd = std::move(eraseEnd, dataEnd, eraseBegin);
+					destroyElements(newDataEnd, dataEnd);
+					dataEnd = newDataEnd;
+				}
+			}
+			return eraseBegin;
+		}
 
-		// iterator erase(const_iterator pos);
-		// iterator erase(const_iterator first, const_iterator last);
+		//Erases the element at pos by moving the last element into its place
+		//	O(1), but doesn't preserve the order of the elements
+		iterator erase_unordered(const_iterator pos) {
+			pointer position = dataBegin + (pos - cbegin());
+			pointer last = dataEnd - 1;
+			if (position != last) {
+				if constexpr (is_trivially_relocatable_v<value_type>) {
+					allocatorTraits::destroy(vectorAllocator, position);
+					std::memcpy(static_cast<void*>(position), static_cast<const void*>(last), sizeof(value_type));
+					--dataEnd;
+					return position;
+				} else {
+					*position = std::move(*last);
+				}
+			}
+			pop_back();
+			return position;
+		}
 
 		void push_back(const value_type &obj) {
-			reallocateIfNecessary();
-			allocatorTraits::construct(vectorAllocator, dataEnd, obj);
-			++dataEnd;
+			emplace_back(obj);
 		}
 
 		void push_back(value_type &&obj) {
-			reallocateIfNecessary();
-			allocatorTraits::construct(vectorAllocator, dataEnd, std::move(obj));
-			++dataEnd;
+			emplace_back(std::move(obj));
 		}
 
 		template<class... Args>
 		reference emplace_back(Args&&... args) {
-			reallocateIfNecessary();
+			if (dataEnd == containerEnd) {
+				return growAndEmplaceBack(std::forward<Args>(args)...);
+			}
 			allocatorTraits::construct(vectorAllocator, dataEnd, std::forward<Args>(args)...);
 			return *(dataEnd++);
 		}
 		
+		//push_back/emplace_back for callers that have already reserved room, so hot loops don't branch on
+		//	capacity. Running out of capacity is undefined behaviour, checked only by assert
+		void push_back_unchecked(const value_type &obj) {
+			emplace_back_unchecked(obj);
+		}
+
+		void push_back_unchecked(value_type &&obj) {
+			emplace_back_unchecked(std::move(obj));
+		}
+
+		template<class... Args>
+		reference emplace_back_unchecked(Args&&... args) {
+			assert(dataEnd != containerEnd && "vector::emplace_back_unchecked() without spare capacity");
+			allocatorTraits::construct(vectorAllocator, dataEnd, std::forward<Args>(args)...);
+			return *(dataEnd++);
+		}
+
+		//Appends count elements, the i'th constructed from generator(i). Room is made once, then generator
+		//	is called for each index in order
+		template<class Generator>
+		void append_n(size_type count, Generator generator) {
+			insertElements(size(), count, [&](pointer destination) {
+				auto constructElement = [&](pointer element, size_type index) {
+					allocatorTraits::construct(vectorAllocator, element, generator(index));
+				};
+				constructChunk(destination, 0, count, constructElement);
+			});
+		}
+
+		//Appends the elements of range, which may be part of this vector. Forward ranges make room once
+		template<class Range>
+		void append_range(Range &&range) {
+			auto first = std::begin(range);
+			auto last = std::end(range);
+			using InputIt = decltype(first);
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+				const size_type count = std::distance(first, last);
+				insertElements(size(), count, [&](pointer destination) {
+					constructRange(destination, first, count);
+				});
+			} else {
+				appendInputRange(first, last);
+			}
+		}
+
 		void pop_back() {
 			--dataEnd;
 			allocatorTraits::destroy(vectorAllocator, dataEnd);
@@ -660,12 +2246,8 @@ namespace sandsnip3r {
 		void resize(size_type count) {
 			auto dataSize = size();
 			if (dataSize < count) {
-				reallocateToNewSizeIfNecessary(count);
-				for (auto i=dataSize; i<count; ++i) {
-					//Fill with default constructed elements
-					allocatorTraits::construct(vectorAllocator, dataEnd);
-					++dataEnd;
-				}
+				//Fill with value-initialized elements
+				growValueInitialized(count);
 			} else if (dataSize > count) {
 				//Resize down(destroying things at the end), dont deallocate
 				resizeDown(count);
@@ -675,52 +2257,70 @@ namespace sandsnip3r {
 		void resize(size_type count, const value_type &value) {
 			auto dataSize = size();
 			if (dataSize < count) {
-				reallocateToNewSizeIfNecessary(count);
-				for (auto i=dataSize; i<count; ++i) {
-					//Fill with default constructed elements
-					allocatorTraits::construct(vectorAllocator, dataEnd, value);
-					++dataEnd;
+				if (count > capacity() && isElement(value)) {
+					//Growing would move value out from under us
+					value_type copy(value);
+					resize(count, copy);
+					return;
 				}
+				reallocateToNewSizeIfNecessary(count);
+				constructCopies(dataEnd, count - dataSize, value);
+				dataEnd = dataBegin + count;
 			} else if (dataSize > count) {
 				//Resize down(destroying things at the end), dont deallocate
 				resizeDown(count);
 			}
 		}
 
-		void swap(vector &other) {
+		//Like resize(count), but new elements are default-initialized, so trivial types are left
+		//	uninitialized for the caller to fill
+		void resize_for_overwrite(size_type count) {
+			if (size() < count) {
+				growDefaultInitialized(count);
+			} else {
+				resizeDown(count);
+			}
+		}
+
+		//Grows to count default-initialized elements and calls op(data(), count), which writes the new
+		//	contents and returns how many elements to keep (at most count)
+		template<class Operation>
+		void resize_and_overwrite(size_type count, Operation op) {
+			resize_for_overwrite(count);
+			const size_type newSize = std::move(op)(data(), count);
+			assert(newSize <= count && "vector::resize_and_overwrite() op returned more than count");
+			resizeDown(newSize);
+		}
+
+		void swap(vector &other) noexcept(allocatorTraits::propagate_on_container_swap::value || allocatorTraits::is_always_equal::value) {
+			swapStorage(other);
+		}
+
+	protected:
+		//Swapping a small_vector's inline storage means moving elements, which small_vector::swap exposes
+		//	without the noexcept
+		void swapStorage(vector &other) {
+			if (this->usesInlineStorage() || other.usesInlineStorage()) {
+				//Inline storage can't change owners, swap through moves instead
+				vector temp(std::move(other), other.get_allocator());
+				other.moveAssign(*this);
+				this->moveAssign(temp);
+				return;
+			}
 			if (typename allocatorTraits::propagate_on_container_swap()) {
 				//Exchange allocators
-				std::swap(vectorAllocator, other.vectorAllocator);
+				using std::swap;
+				swap(vectorAllocator, other.vectorAllocator);
 			}
 			std::swap(dataBegin, other.dataBegin);
 			std::swap(dataEnd, other.dataEnd);
 			std::swap(containerEnd, other.containerEnd);
 		}
-
-		//std::swap
 	};
 
-	template<class T, class Alloc>
-	bool operator==(const vector<T, Alloc> &left, const vector<T, Alloc> &right) {
-		if (left.size() != right.size()) {
-			return false;
-		}
-		auto leftIt = left.begin();
-		auto leftEnd = left.end();
-		auto rightIt = right.begin();
-		if (leftIt != leftEnd) {
-			if (*leftIt != *rightIt) {
-				return false;
-			}
-			++leftIt;
-			++rightIt;
-		}
-		return true;
-	}
-
-	template<class T, class Alloc>
-	bool operator!=(const vector<T, Alloc> &left, const vector<T, Alloc> &right) {
-		return !(left == right);
+	template<class T, class Alloc, class Growth, class Storage>
+	void swap(vector<T, Alloc, Growth, Storage> &left, vector<T, Alloc, Growth, Storage> &right) noexcept(noexcept(left.swap(right))) {
+		left.swap(right);
 	}
 
 	template<class Iterator1, class Iterator2>
@@ -739,41 +2339,134 @@ namespace sandsnip3r {
 		return (leftIt == leftEnd) && (rightIt != rightEnd);
 	}
 
-	template<class Iterator1, class Iterator2>
-	bool myComparisonWithEqual(Iterator1 leftIt, Iterator1 leftEnd, Iterator2 rightIt, Iterator2 rightEnd) {
-		while ((leftIt != leftEnd) && (rightIt != rightEnd)) {
-			if (*leftIt < *rightIt) {
+	namespace detail {
+
+		//Types whose values are equal exactly when their bytes are
+		template<class Type>
+		struct is_bitwise_comparable : std::integral_constant<bool,
+			std::is_integral<Type>::value || std::is_enum<Type>::value || std::is_pointer<Type>::value> {};
+
+		//Types whose order is the order memcmp gives their bytes
+		template<class Type>
+		struct is_bytewise_ordered : std::integral_constant<bool,
+			(std::is_integral<Type>::value && std::is_unsigned<Type>::value && sizeof(Type) == 1) || std::is_same<Type, std::byte>::value> {};
+
+		template<class Type, class = void>
+		struct has_equal : std::false_type {};
+
+		template<class Type>
+		struct has_equal<Type, std::void_t<decltype(std::declval<const Type&>() == std::declval<const Type&>())>> : std::true_type {};
+
+		//Index of the first element that differs. Whole blocks are compared with memcmp, which runs at
+		//	memory bandwidth, and only the block containing the difference is scanned element by element
+		template<class Type>
+		std::size_t bitwiseMismatch(const Type *left, const Type *right, std::size_t count) {
+			constexpr std::size_t BLOCK_SIZE = std::max<std::size_t>(256 / sizeof(Type), 1);
+			std::size_t index = 0;
+			while (index + BLOCK_SIZE <= count && std::memcmp(left + index, right + index, BLOCK_SIZE * sizeof(Type)) == 0) {
+				index += BLOCK_SIZE;
+			}
+			while (index < count && left[index] == right[index]) {
+				++index;
+			}
+			return index;
+		}
+
+		template<class Type>
+		bool elementsEqual(const Type *left, const Type *right, std::size_t count) {
+			if constexpr (is_bitwise_comparable<Type>::value) {
+				return count == 0 || std::memcmp(left, right, count * sizeof(Type)) == 0;
+			} else {
+				for (std::size_t i=0; i<count; ++i) {
+					if (!(left[i] == right[i])) {
+						return false;
+					}
+				}
 				return true;
 			}
-			if (*rightIt < *leftIt) {
-				return false;
+		}
+
+		template<class Type>
+		bool lexicographicallyLess(const Type *left, std::size_t leftSize, const Type *right, std::size_t rightSize) {
+			const std::size_t commonSize = std::min(leftSize, rightSize);
+			if constexpr (is_bytewise_ordered<Type>::value) {
+				if (commonSize > 0) {
+					const int result = std::memcmp(left, right, commonSize);
+					if (result != 0) {
+						return result < 0;
+					}
+				}
+				return leftSize < rightSize;
+			} else if constexpr (is_bitwise_comparable<Type>::value || (has_equal<Type>::value && !std::is_floating_point<Type>::value)) {
+				//Find where the ranges differ, then a single operator< decides
+				//	Assumes operator== agrees with operator<, which floating point NaNs don't
+				std::size_t index;
+				if constexpr (is_bitwise_comparable<Type>::value) {
+					index = bitwiseMismatch(left, right, commonSize);
+				} else {
+					index = 0;
+					while (index < commonSize && left[index] == right[index]) {
+						++index;
+					}
+				}
+				if (index < commonSize) {
+					return left[index] < right[index];
+				}
+				return leftSize < rightSize;
+			} else {
+				return myComparisonWithoutEqual(left, left + leftSize, right, right + rightSize);
 			}
-			++leftIt;
-			++rightIt;
 		}
-		//If leftIt!=leftEnd, that means that it still has remaining elements but right doesnt
-		//	this means right is a subset of left
-		return leftIt == leftEnd;
 	}
-	
-	template<class T, class Alloc>
-	bool operator<(const vector<T, Alloc> &left, const vector<T, Alloc> &right) {
-		return myComparisonWithoutEqual(left.begin(), left.end(), right.begin(), right.end());
+
+	template<class T, class Alloc, class Growth, class Storage>
+	bool operator==(const vector<T, Alloc, Growth, Storage> &left, const vector<T, Alloc, Growth, Storage> &right) {
+		if (left.size() != right.size()) {
+			return false;
+		}
+		return detail::elementsEqual(left.data(), right.data(), left.size());
+	}
+
+	template<class T, class Alloc, class Growth, class Storage>
+	bool operator!=(const vector<T, Alloc, Growth, Storage> &left, const vector<T, Alloc, Growth, Storage> &right) {
+		return !(left == right);
+	}
+
+	template<class T, class Alloc, class Growth, class Storage>
+	bool operator<(const vector<T, Alloc, Growth, Storage> &left, const vector<T, Alloc, Growth, Storage> &right) {
+		return detail::lexicographicallyLess(left.data(), left.size(), right.data(), right.size());
+	}
+
+	template<class T, class Alloc, class Growth, class Storage>
+	bool operator<=(const vector<T, Alloc, Growth, Storage> &left, const vector<T, Alloc, Growth, Storage> &right) {
+		return !(right < left);
+	}
+
+	template<class T, class Alloc, class Growth, class Storage>
+	bool operator>(const vector<T, Alloc, Growth, Storage> &left, const vector<T, Alloc, Growth, Storage> &right) {
+		return right < left;
 	}
 
-	template<class T, class Alloc>
-	bool operator<=(const vector<T, Alloc> &left, const vector<T, Alloc> &right) {
-		return myComparisonWithEqual(left.begin(), left.end(), right.begin(), right.end());
+	template<class T, class Alloc, class Growth, class Storage>
+	bool operator>=(const vector<T, Alloc, Growth, Storage> &left, const vector<T, Alloc, Growth, Storage> &right) {
+		return !(left < right);
 	}
 
-	template<class T, class Alloc>
-	bool operator>(const vector<T, Alloc> &left, const vector<T, Alloc> &right) {
-		return myComparisonWithoutEqual(right.begin(), right.end(), left.begin(), left.end());
+	//Erases every element for which pred returns true in a single pass, returning how many were erased
+	template<class T, class Alloc, class Growth, class Storage, class Pred>
+	typename vector<T, Alloc, Growth, Storage>::size_type erase_if(vector<T, Alloc, Growth, Storage> &v, Pred pred) {
+		auto newEnd = std::remove_if(v.begin(), v.end(), pred);
+		const typename vector<T, Alloc, Growth, Storage>::size_type erasedCount = v.end() - newEnd;
+		v.erase(newEnd, v.end());
+		return erasedCount;
 	}
 
-	template<class T, class Alloc>
-	bool operator>=(const vector<T, Alloc> &left, const vector<T, Alloc> &right) {
-		return myComparisonWithEqual(right.begin(), right.end(), left.begin(), left.end());
+	//Erases every element equal to value, returning how many were erased
+	template<class T, class Alloc, class Growth, class Storage, class U>
+	typename vector<T, Alloc, Growth, Storage>::size_type erase(vector<T, Alloc, Growth, Storage> &v, const U &value) {
+		return erase_if(v, [&value](const T &element) {
+			return element == value;
+		});
 	}
 }
 